@@ -3,34 +3,692 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <functional>
 #include <regex>
 #include <stdexcept>
 #include <limits>
 #include <iomanip>
+#include <climits>
+#include <cstdint>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <cstdio>
+#include <thread>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
+#include <array>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <random>
+#include <unordered_map>
+#include <optional>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
+// Read-only view of a whole file. On POSIX the file is mmap'ed so nothing is
+// copied; elsewhere it is read into a single buffer. A missing or empty file
+// gives an empty view.
+class MappedFile {
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    string buffer;
+#endif
+
+public:
+    explicit MappedFile(const string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    string_view view() const;
+};
+
+// Walks a buffer line by line in a single forward pass and splits each line
+// into string_view fields. Nothing is allocated; callers materialize strings
+// only for the records they keep.
+class FieldScanner {
+private:
+    string_view text;
+    string_view current;
+    size_t offset = 0;
+    size_t lineNo = 0;
+
+public:
+    explicit FieldScanner(string_view t);
+    bool nextLine();
+    string_view line() const;
+    size_t lineNumber() const;
+    // Splits the current line at its first `count - 1` commas; the last field
+    // takes the rest of the line. Returns false if there are too few fields.
+    bool split(string_view* fields, size_t count) const;
+    static bool toInt(string_view field, int& value);
+};
+
+// Parses a large buffer on several threads. The buffer is cut at line breaks
+// into one chunk per worker thread, each at least MIN_CHUNK_BYTES, so small
+// files are still parsed in one piece on the calling thread. Callers keep one
+// result per chunk and merge them in chunk order, which is file order.
+class ChunkedParser {
+public:
+    static const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+    // 0, the default, uses one worker per hardware thread.
+    static void setThreads(unsigned count);
+    static unsigned threads();
+    static vector<string_view> split(string_view text);
+    // Calls parse(i, chunks[i]) for every chunk and returns once all are done.
+    static void run(const vector<string_view>& chunks, const function<void(size_t, string_view)>& parse);
+
+private:
+    static atomic<unsigned> threadCount;
+};
+
+// Size and modification time of a file, used to tell whether a derived
+// index written earlier still matches the file it was built from.
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+
+    static FileStamp of(const string& path);
+    bool operator==(const FileStamp& other) const;
+    bool operator!=(const FileStamp& other) const;
+};
+
+// Process-wide operation counters, latency histograms and file I/O totals,
+// cheap enough to leave on in production. Each histogram has one bucket per
+// power of two nanoseconds, so percentiles are upper bounds accurate to a
+// factor of two. Counters are atomic so server threads can record freely.
+class Stats {
+public:
+    enum Operation { Load, Add, Modify, Delete, Register, Allocate, Optimize,
+                     DisplayAll, DisplayCategory, DisplayOrganizer, DisplayRange, Query, OPERATION_COUNT };
+
+    // Records the time from construction to destruction against an operation.
+    class Timer {
+    public:
+        explicit Timer(Operation op);
+        ~Timer();
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        Operation operation;
+        chrono::steady_clock::time_point start;
+    };
+
+    static void record(Operation op, uint64_t nanos);
+    static void addBytesRead(uint64_t bytes);
+    static void addBytesWritten(uint64_t bytes);
+    static void countEventsParse();
+    static void countParticipantsParse();
+    // One "stats key=value ..." line for log scrapers.
+    static string line();
+    static void dump(ostream& out);
+
+private:
+    static const int BUCKETS = 48;
+    struct Histogram {
+        atomic<uint64_t> count{0};
+        atomic<uint64_t> totalNanos{0};
+        atomic<uint64_t> maxNanos{0};
+        array<atomic<uint64_t>, BUCKETS> buckets{};
+    };
+    static const char* const names[OPERATION_COUNT];
+    static Histogram histograms[OPERATION_COUNT];
+    static atomic<uint64_t> bytesRead, bytesWritten, eventsParses, participantsParses;
+    static const chrono::steady_clock::time_point started;
+
+    static double percentileMicros(const Histogram& histogram, uint64_t count, double fraction);
+};
+
+// Reports Stats for --stats and --stats-interval: prints a stats line to
+// stderr every interval from a background thread, and the full table when
+// it goes out of scope.
+class StatsReporter {
+public:
+    StatsReporter(bool dumpOnExit, int intervalSeconds);
+    ~StatsReporter();
+
+private:
+    bool dumpOnExit;
+    thread ticker;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
+};
+
+// Single-pass, allocation-free parsers for the date and time formats the
+// scheduler accepts. They check the same shapes as the regular expressions
+// they replace, YYYY-MM-DD and (1[0-9]|2[0-3]|0?[0-9]):[0-5][0-9], and
+// produce the integers directly.
+struct DateParts {
+    int year = 0, month = 0, day = 0;
+};
+
+struct TimeParts {
+    int hour = 0, minute = 0;
+};
+
+class DateTimeParser {
+public:
+    static bool parseDate(string_view text, DateParts& out);
+    static bool parseTime(string_view text, TimeParts& out);
+    static int daysInMonth(int year, int month);
+
+    // Events keep dates as days since 1970-01-01 and times as minutes since
+    // midnight; these convert at the I/O boundary. The parse* forms throw
+    // invalid_argument on malformed text.
+    static int toDayNumber(const DateParts& date);
+    static DateParts fromDayNumber(int day);
+    static int parseDayNumber(string_view text);
+    static int parseMinutes(string_view text);
+    static string formatDate(int day);
+    static string formatTime(int minutes);
+};
+
+// Organizers and venues repeat across many events, so each distinct string
+// is stored once here and events hold its 32-bit id. Id 0 is the empty
+// string. Strings are never removed, so references returned by lookup()
+// stay valid for the life of the process. Safe to use from any thread.
+class StringPool {
+public:
+    static uint32_t intern(string_view text);
+    // Sets `id` and returns true if `text` has been interned; never adds it.
+    static bool find(string_view text, uint32_t& id);
+    static const string& lookup(uint32_t id);
+
+private:
+    struct Table {
+        shared_mutex lock;
+        deque<string> strings{string()};
+        unordered_map<string_view, uint32_t> ids{{string_view(), 0}};
+    };
+    static Table& table();
+};
+
+class EventTable;
+
 class Event {
+    friend class EventTable;
+
+public:
+    // The categories offered by the menus; nothing else can be stored.
+    enum class Category : uint8_t { Workshop, Seminar, Lecture, Exam, FormalEvent, Miscellaneous };
+    static const int CATEGORY_COUNT = 6;
+    // Throws invalid_argument for a name that is not one of the categories.
+    static Category parseCategory(string_view text);
+    static bool isCategory(string_view text);
+    static const string& categoryName(Category category);
+
 private:
-    string name, organizer, category, date, startTime, endTime, venue;
-    int seats;
+    string name;
+    uint32_t organizer = 0;  // StringPool ids
+    uint32_t venue = 0;
+    Category category = Category::Workshop;
+    int day = 0;          // days since 1970-01-01
+    int startMinute = 0;  // minutes since midnight
+    int endMinute = 0;
+    int seats = 0;
 
 public:
     Event();
+    // Parses the category, date and times; throws invalid_argument if they
+    // are malformed.
     Event(string n, string o, string c, string d, string st, string et, int s, string v);
+    Event(string n, string o, string c, int d, int st, int et, int s, string v);
     string getName() const;
-    string getOrganizer() const;
-    string getCategory() const;
+    const string& getOrganizer() const;
+    const string& getCategory() const;
+    uint32_t getOrganizerId() const;
+    Category getCategoryId() const;
+    uint32_t getVenueId() const;
     string getDate() const;
     string getStartTime() const;
     string getEndTime() const;
-    string getVenue() const;
+    int getDay() const;
+    int getStartMinute() const;
+    int getEndMinute() const;
+    const string& getVenue() const;
     int getSeats() const;
-    void save() const;
-    static vector<Event> loadAll();
+    void save(const string& path = "events.txt") const;
+    // Lines that cannot be read are reported on cerr, skipped and counted
+    // in `*skipped`.
+    static EventTable loadAll(const string& path = "events.txt", size_t* skipped = nullptr);
+    static void saveAll(const EventTable& events, const string& path = "events.txt");
     void display() const;
 };
 
+// Events stored column by column. Each field is one contiguous array indexed
+// by row, so a scan over dates, times or rooms reads only the integers it
+// needs. Names are appended to a single character arena and addressed by
+// offset. A renamed or erased row leaves its old name behind until more than
+// half the arena is garbage, when it is repacked. Dropping or reloading the
+// table frees everything at once.
+//
+// Row numbers are stable: erase() only marks the row, so indexes that hold
+// row numbers stay valid and a delete costs O(1). Erased rows are skipped by
+// every reader and removed in one pass by dropErased().
+class EventTable {
+    friend class EventStore;  // snapshots copy the columns directly
+
+public:
+    // Row numbers run from 0 to size(); erased rows keep theirs until
+    // dropErased().
+    size_t size() const;
+    size_t liveRows() const;
+    // True if no row is live.
+    bool empty() const;
+    bool isErased(size_t row) const;
+    void reserve(size_t rows, size_t nameBytes);
+    void append(string_view name, uint32_t organizer, Event::Category category, int day, int startMinute,
+                int endMinute, int seats, uint32_t venue);
+    void append(const Event& event);
+    // Appends every row of `rows`, in order.
+    void append(const EventTable& rows);
+    void append(const EventTable& rows, size_t row);
+    void assign(size_t row, const Event& event);
+    void erase(size_t row);
+    // Removes the erased rows; the others keep their order but are renumbered.
+    void dropErased();
+    // Builds a standalone Event from one row.
+    Event row(size_t row) const;
+
+    string_view name(size_t row) const;
+    uint32_t organizer(size_t row) const;
+    Event::Category category(size_t row) const;
+    int day(size_t row) const;
+    int startMinute(size_t row) const;
+    int endMinute(size_t row) const;
+    int seats(size_t row) const;
+    uint32_t venue(size_t row) const;
+
+private:
+    vector<int32_t> days, startMinutes, endMinutes, seatCounts;
+    vector<uint32_t> organizers, venues;  // StringPool ids
+    vector<Event::Category> categories;
+    vector<uint64_t> nameOffsets;
+    vector<uint32_t> nameLengths;
+    vector<uint8_t> erasedFlags;  // 1 for rows removed by erase()
+    size_t erasedRows = 0;
+    string arena;
+    size_t garbage = 0;  // arena bytes no row refers to
+
+    void repack();
+};
+
+// Finds the rows of an EventTable by event name without a second copy of
+// the names. Open addressing over row numbers, each stored with a 32-bit hash
+// of its name; a probe reads the name from the table only when the hashes
+// agree. Linear probing, kept at most half full. A removed row leaves a
+// marker until the next rehash. The hash is FNV-1a rather than std::hash so
+// that the slots saved in a snapshot stay valid across builds.
+class EventNameIndex {
+    friend class EventStore;  // snapshots copy the slots directly
+
+public:
+    static const size_t npos = SIZE_MAX;
+
+    explicit EventNameIndex(const EventTable& t);
+    void clear();
+    void reserve(size_t rows);
+    size_t size() const;
+    // The row named `name`, or npos.
+    size_t find(string_view name) const;
+    // Adds a row whose name is not in the index yet.
+    void insert(size_t row);
+    // Removes a row; call it before the row's name changes.
+    void erase(size_t row);
+
+private:
+    struct Slot {
+        uint32_t row;
+        uint32_t hash;
+    };
+    static const uint32_t EMPTY = UINT32_MAX;
+    static const uint32_t REMOVED = UINT32_MAX - 1;
+
+    const EventTable& table;
+    vector<Slot> slots;  // a power of two in size, or empty
+    size_t live = 0;
+    size_t used = 0;     // live rows plus removal markers
+
+    static uint32_t hashOf(string_view name);
+    static size_t capacityFor(size_t rows);
+    void rehash(size_t capacity);
+};
+
+// A weekly or fortnightly event, stored once as its first occurrence plus a
+// repeat interval and count. Occurrences are worked out when they are needed
+// and never stored as separate events.
+struct EventSeries {
+    static const int MAX_OCCURRENCES = 520;
+
+    Event first;
+    int intervalDays = 7;
+    int count = 1;
+
+    int lastDay() const;
+    Event occurrence(int index) const;
+};
+
+// Versioned binary columnar event file. Dates, times, seats and string ids
+// are stored as fixed-width integer columns, and names, organizers,
+// categories and venues live in a shared string table. Event names may
+// therefore contain commas. A load is a bulk copy of each column with no
+// per-field parsing. Integers are written in host byte order.
+//
+// Layout: header | date[] start[] end[] seats[] venue[] name[] organizer[]
+// category[] | string offsets[stringCount + 1] | string bytes
+class EventBinaryFile {
+public:
+    static const uint32_t MAGIC = 0x42535645;  // "EVSB"
+    static const uint32_t VERSION = 1;
+
+    static bool matches(const string& path);
+    // A file that cannot be read at all counts as one skipped row.
+    static EventTable load(const string& path, size_t* skipped = nullptr);
+    static void save(const EventTable& events, const string& path);
+    // Converts in either direction; the format of each side follows its extension.
+    static void convert(const string& from, const string& to);
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t rowCount;
+        uint32_t stringCount;
+        uint64_t stringBytes;
+    };
+};
+
+// Keeps every event resident in memory. The file is parsed once by load();
+// after that all reads are served from memory and every change is written
+// through to disk.
+//
+// Changes are not written to the base file directly. Each add, update and
+// delete is appended to `<file>.journal` as a single line. load() replays the
+// journal over the base file. Once the journal grows past a threshold,
+// compaction runs on a background thread. It rotates the journal to
+// `<file>.journal.old`, writes a snapshot of the events to a temporary file,
+// renames that over the base file and removes the old journal. Replaying
+// the journal is idempotent, so a crash at any step loses no edits.
+//
+// On a clean shutdown the events, their name order and the ordered indexes are
+// written to `<file>.snapshot`. The snapshot is stamped with the size and
+// mtime of the base file, both journals and the series file, as they were
+// when memory last matched them. load() uses the snapshot only if all four
+// stamps still match. Otherwise it parses the files as usual. If another
+// process changed a file while we ran, no snapshot is written.
+//
+// Room occupancy is tracked per (venue, date) as a 32-bit mask: working hours
+// 08:00-16:00 split into 15-minute slots is exactly 32 slots, so checking a
+// room is a single AND. The per-slot depth lets a booking be released without
+// rescanning the day when overlapping bookings already exist on file.
+class EventStore {
+public:
+    static const int SLOT_COUNT = 32;
+    static const int SLOT_MINUTES = 15;
+    static const int DAY_START_MINUTE = 8 * 60;
+    static const size_t COMPACT_THRESHOLD = 1024;
+
+private:
+    struct SlotDay {
+        uint32_t mask = 0;
+        uint16_t depth[SLOT_COUNT] = {};
+    };
+    using VenueDays = unordered_map<int, SlotDay>;
+    struct SourceStamps {
+        FileStamp base, journal, oldJournal, series;
+        bool operator==(const SourceStamps& other) const;
+        bool operator!=(const SourceStamps& other) const;
+    };
+    struct SnapshotHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t rowCount;
+        uint64_t indexedCount;  // rows listed in the ordered indexes
+        uint64_t arenaBytes;
+        uint64_t poolCount;     // organizer and venue names
+        uint64_t poolBytes;
+        uint64_t nameSlots;     // EventNameIndex capacity
+        uint64_t bookedDays;    // (venue, day) occupancy entries
+        uint64_t journalEntries;
+        uint64_t unreadableLines;
+        SourceStamps stamps;
+    };
+    struct BookedDay {
+        uint32_t venue;  // index into the snapshot's string pool
+        int32_t day;
+        SlotDay slots;
+    };
+    static const uint32_t SNAPSHOT_MAGIC = 0x53535645;  // "EVSS"
+    static const uint32_t SNAPSHOT_VERSION = 5;
+
+    string path;
+    string journalPath;
+    string seriesPath;
+    string snapshotPath;
+    bool binary;
+    bool loaded = false;
+    bool readOnly = false;
+    SourceStamps expected;       // the files as of our last read or write
+    SourceStamps snapshotStamps; // the files the snapshot on disk matches
+    EventTable events;
+    vector<EventSeries> series;
+    unordered_map<string, size_t> seriesByName;
+    EventNameIndex byName{events};
+    unordered_map<uint32_t, VenueDays> occupancy;  // venue id -> day -> slots
+    // Orderings kept current on every change, so sorted listings walk an
+    // index instead of sorting. Each key ends with the event's row, which
+    // breaks ties in stored order; names and venues are never copied in.
+    using DayIndex = set<tuple<int, int, uint32_t>>;  // day, start minute, row
+    DayIndex byDate;
+    set<tuple<int, int, uint32_t>> byStart;      // start minute, day, row
+    unordered_map<uint32_t, DayIndex> byVenue;   // venue id
+    // Secondary indexes, each kept in date order.
+    array<DayIndex, Event::CATEGORY_COUNT> byCategory;
+    unordered_map<uint32_t, DayIndex> byOrganizer;  // organizer id
+    ofstream journal;
+    size_t journalEntries = 0;
+    // Base file lines and journal records that could not be read. While
+    // there are any, compaction is refused: rewriting the base file from
+    // memory would delete them.
+    size_t unreadable = 0;
+    bool compactionRefused = false;
+    bool batching = false;
+    thread compactor;
+    bool compacting = false;
+
+    void clearIndexes();
+    // Rebuilds the name and order indexes from the live rows.
+    void reindex();
+    void upsert(const Event& event);
+    bool replace(const string& name, const Event& event);
+    bool erase(const string& name);
+    void replayJournal(const string& file);
+    void appendJournal(const string& entry);
+    static void writeBase(const EventTable& snapshot, const string& path, bool binary);
+    static string journalRecord(const Event& event);
+    static string escapeField(const string& field);
+    static vector<string> splitJournalLine(string_view line);
+    void occupy(uint32_t venue, int day, uint32_t mask);
+    void release(uint32_t venue, int day, uint32_t mask);
+    void occupy(const Event& event);
+    void release(const Event& event);
+    // Both read the row's current values, so unindex before changing a row.
+    void indexOrder(size_t row);
+    void unindexOrder(size_t row);
+    // Without `book`, the occurrences are taken to be in the occupancy
+    // already, as they are after a snapshot load.
+    void loadSeries(bool book = true);
+    void saveSeries(const string& target) const;
+    void joinCompactor();
+    SourceStamps stampSources() const;
+    bool loadSnapshot();
+    void saveSnapshot();
+
+public:
+    enum class Order { Stored, Date, Start, Venue };
+    // A lookup through the indexes: every event, or those with one category,
+    // organizer or venue, optionally limited to a range of days.
+    struct Query {
+        enum Field { Any, Category, Organizer, Venue };
+        Field field = Any;
+        string value;
+        int firstDay = INT_MIN;
+        int lastDay = INT_MAX;
+
+        bool everything() const;
+    };
+
+    explicit EventStore(const string& p = "events.txt");
+    ~EventStore();
+    EventStore(const EventStore&) = delete;
+    EventStore& operator=(const EventStore&) = delete;
+    // A read-only load never writes back, not even the snapshot on exit.
+    void load(bool readOnly = false);
+    void compact(bool background = false);
+    // Between beginBatch() and endBatch() journal entries are buffered and
+    // flushed once, and compaction is deferred to the end of the batch.
+    void beginBatch();
+    void endBatch();
+    const EventTable& table() const;
+    // Visits the rows of table() in the given order until `visit` returns
+    // false. Nothing is copied; the visitor reads the columns it needs.
+    void forEach(Order order, const function<bool(size_t row)>& visit) const;
+    // Visits the rows that match in date order until `visit` returns false.
+    // Only the matching index entries are read, so the cost follows the
+    // result size.
+    void select(const Query& query, const function<bool(size_t row)>& visit) const;
+    optional<Event> find(const string& name) const;
+    // The event's row in table(), or npos if there is none.
+    size_t position(const string& name) const;
+    bool contains(const string& name) const;
+    void add(const Event& event);
+    bool remove(const string& name);
+    // Replaces the event in place. Throws invalid_argument if it is renamed
+    // to a name another event or series already has.
+    bool update(const string& name, const Event& event);
+    bool isSlotFree(const string& venue, int day, uint32_t mask, const Event* ignore = nullptr) const;
+    struct FreeSlot {
+        int day;
+        int startMinute;
+        string venue;
+    };
+    // The earliest starts, in date and time order, at which `slotCount`
+    // consecutive slots are free in one of `venues` between two days. Each
+    // start is offered once, in the first listed venue that has it free.
+    // Every venue's day is read once, and a bit-mask pass over it finds all
+    // of its free runs.
+    vector<FreeSlot> earliestFree(const vector<string>& venues, int firstDay, int lastDay, int slotCount, size_t limit) const;
+    // Recurring series live in `<events file>.series`, rewritten on each
+    // change; their occurrences take up room slots like ordinary events.
+    const vector<EventSeries>& allSeries() const;
+    // Writes the events and series to another events file, in the format
+    // its name selects, replacing any series file it had.
+    void exportTo(const string& target) const;
+    const EventSeries* findSeries(const string& name) const;
+    void addSeries(const EventSeries& entry);
+    bool removeSeries(const string& name);
+    // True if `mask` is free in the venue on every day of the series.
+    bool isSeriesFree(const string& venue, int firstDay, int intervalDays, int count, uint32_t mask) const;
+    // Visits the series occurrences that match a query with a day range.
+    void forEachOccurrence(const Query& query, const function<bool(const Event&)>& visit) const;
+    static uint32_t slotMask(int startMinute, int endMinute);
+};
+
+// The rooms events can be booked into. They are read at start-up from a
+// venues file with one "name,capacity[,attribute;attribute...]" line per
+// room, for example "CS Lab 3,130,lab;projector"; blank lines and # comments
+// are skipped. Without a file the original campus rooms are used. Rooms are
+// kept sorted by capacity and then name, so best fit is a binary search for
+// the first room that is big enough followed by a scan to the first free one.
+class VenueCatalogue {
+public:
+    struct Venue {
+        string name;
+        int capacity = 0;
+        vector<string> attributes;
+
+        bool hasAttribute(const string& attribute) const;
+    };
+
+    VenueCatalogue();
+    static VenueCatalogue load(const string& path);
+    const vector<Venue>& all() const;
+    // The smallest venue that seats at least `seats`, or all().end().
+    vector<Venue>::const_iterator firstFitting(int seats) const;
+    const Venue* find(const string& name) const;
+
+private:
+    vector<Venue> venues;
+    unordered_map<string, size_t> byName;
+
+    bool add(Venue venue);
+    void sortByCapacity();
+};
+
+// Places a group of new events together instead of first come, first
+// served. Larger events go first by best fit. Then, while the time budget
+// lasts, a local search moves already-placed members of the group aside to
+// fit events that were left over, and shifts events into smaller free rooms.
+// The aim is fewest unplaced events first, then fewest wasted seats.
+// Bookings already in the store are fixed.
+class VenueOptimizer {
+public:
+    struct Room {
+        string name;
+        int capacity;
+    };
+    struct Request {
+        int day;
+        uint32_t mask;
+        int seats;
+    };
+
+    VenueOptimizer(const EventStore& s, vector<Room> r, chrono::milliseconds budget);
+    // Returns, per request, an index into the rooms, or -1 if it could not be placed.
+    vector<int> place(const vector<Request>& requests);
+    const Room& room(int index) const;
+
+private:
+    const EventStore& store;
+    vector<Room> rooms;
+    chrono::steady_clock::time_point deadline;
+    const vector<Request>* requests = nullptr;
+    vector<int> assigned;
+    unordered_map<string, vector<int>> placed;  // day + room -> group members booked there
+
+    string key(int request, int room) const;
+    bool fits(int request, int room) const;
+    int bestFit(int request) const;
+    void assign(int request, int room);
+    void unassign(int request);
+    bool makeRoomFor(int request);
+    bool expired() const;
+};
+
 class Participant {
 private:
     string name, rollNumber, department, phoneNumber, eventName;
@@ -38,19 +696,150 @@ private:
 public:
     Participant();
     Participant(string n, string r, string d, string p, string e);
-    void save() const;
-    static map<string, int> countByEvent();
+    string getName() const;
+    string getRollNumber() const;
+    string getDepartment() const;
+    string getPhoneNumber() const;
+    string getEventName() const;
+    void write(ostream& out) const;
+    void save(const string& path = "participants.txt") const;
+    static map<string, int> countByEvent(const string& path = "participants.txt");
+};
+
+// The (event, roll number) pairs that hold a seat or a waitlist place. Most
+// lookups are for pairs that are not there, so a Bloom filter sits in front
+// of the hash table and answers those from a few bits, without building a key
+// or probing the table. Removed pairs stay set in the filter and only cost a
+// probe. The filter is rebuilt at twice the size whenever the table outgrows
+// it. Pairs are counted, so files that already hold duplicates stay exact.
+class RegistrationKeys {
+public:
+    void clear();
+    bool contains(string_view eventName, string_view rollNumber) const;
+    void insert(string_view eventName, string_view rollNumber);
+    void erase(string_view eventName, string_view rollNumber);
+
+private:
+    static const size_t BITS_PER_KEY = 10;  // about 1% false positives
+    static const int PROBES = 7;
+
+    vector<uint64_t> bloom;
+    unordered_map<string, uint32_t> counts;  // "event\nroll number"
+
+    static uint64_t hash(string_view eventName, string_view rollNumber);
+    static string key(string_view eventName, string_view rollNumber);
+    bool mayContain(uint64_t h) const;
+    void mark(uint64_t h);
+};
+
+// Per-event registration counts, kept up to date as participants register so
+// listings never rescan participants.txt. The counts are persisted in a
+// sidecar (`participants.txt.idx`) stamped with the participants file's size
+// and mtime; on load a matching stamp is trusted, anything else triggers a
+// rebuild. If another process appends while we run, the sidecar is dropped
+// rather than written with stale counts.
+//
+// Registration is capped at the event's seats. Seats are reserved with a
+// compare-and-swap on the event's counter under the file lock, which also
+// covers the duplicate check and the append, so concurrent registrations
+// never oversubscribe and readers of the counts never block. Requests past
+// capacity join a FIFO waitlist (`participants.txt.waitlist`), whose head is
+// promoted when a registration is cancelled or the event gains seats.
+//
+// A roll number can hold one place per event, registered or waitlisted.
+// The pairs are read from participants.txt on the first registration, not at
+// start-up, so the counts sidecar still spares a parse on launch. The same
+// pass re-reads the counts, and it is repeated whenever another process has
+// changed the file.
+class RegistrationIndex {
+public:
+    struct Outcome {
+        bool waitlisted = false;
+        size_t position = 0;  // 1-based place in the waitlist
+    };
+    struct Cancellation {
+        bool found = false;
+        vector<Participant> promoted;
+    };
+
+private:
+    struct SeatCounter {
+        atomic<int> taken{0};
+    };
+
+    string path;
+    string indexPath;
+    string waitlistPath;
+    // Counters are never erased after loading, so references stay valid;
+    // countsLock only guards inserting new events into the map.
+    unordered_map<string, SeatCounter> counts;
+    mutable shared_mutex countsLock;
+    // fileLock serializes the files, the waitlists and the fields below it.
+    mutex fileLock;
+    unordered_map<string, deque<Participant>> waitlists;
+    RegistrationKeys keys;
+    bool keysLoaded = false;
+    uint64_t expectedSize = 0;
+    bool stale = false;
+    bool dirty = false;
+    ofstream batchFile;
+
+    bool loadSidecar();
+    void rebuild();
+    void loadWaitlist();
+    void saveWaitlist();
+    void loadKeys();
+    SeatCounter& counter(const string& eventName);
+    static bool tryReserve(SeatCounter& seats, int capacity);
+    void append(const Participant& participant);
+    bool removeRegistration(const string& eventName, const string& rollNumber);
+    void rewrite(const string& contents);
+    vector<Participant> promoteLocked(const string& eventName, int capacity);
+
+public:
+    explicit RegistrationIndex(const string& p = "participants.txt");
+    ~RegistrationIndex();
+    RegistrationIndex(const RegistrationIndex&) = delete;
+    RegistrationIndex& operator=(const RegistrationIndex&) = delete;
+    void load();
+    void save();
+    int count(const string& eventName) const;
+    size_t waitlistLength(const string& eventName);
+    // Registers the participant if one of `capacity` seats is free,
+    // otherwise appends them to the event's waitlist. Throws
+    // invalid_argument if the roll number already has a place in the event.
+    Outcome enrol(const Participant& participant, int capacity);
+    // Removes a registration or waitlist entry by roll number and fills a
+    // freed seat from the waitlist.
+    Cancellation cancel(const string& eventName, const string& rollNumber, int capacity);
+    // Fills seats from the waitlist after the event's capacity has grown.
+    vector<Participant> promote(const string& eventName, int capacity);
+    // Moves an event's registrations, waitlist and count to its new name.
+    // participants.txt is rewritten, as for a cancellation.
+    void renameEvent(const string& from, const string& to);
+    // Keeps participants.txt open across a batch and writes it out once.
+    void beginBatch();
+    void endBatch();
 };
 
 class EventManagementSystem {
 public:
+    explicit EventManagementSystem(const string& eventsPath = "events.txt", const string& participantsPath = "participants.txt",
+                                   const string& venuesPath = "venues.txt");
     void run();
+    int runBatch(istream& in, ostream& out);
+    int serve(const string& socketPath);
+    static int connect(const string& socketPath);
+    void setAllocationBudget(chrono::milliseconds budget);
     static void printHeader(const string& title);
+    const VenueCatalogue& venueCatalogue() const;
 
 private:
-    void validateDate(const string& date);
-    void validateTime(const string& startTime, const string& endTime);
-    string roundTimeToNextInterval(const string& time);
+    friend class Benchmarks;
+
+    static void validateDate(const string& date);
+    static void validateTime(const string& startTime, const string& endTime);
+    static string roundTimeToNextInterval(const string& time);
     void organizerMenu();
     void displayScheduledEvents();
     void addNewEvent();
@@ -58,777 +847,4817 @@ private:
     void participantMenu();
     void displayEventsForParticipants();
     void registerForEvent();
-    string allocateVenue(const string& date, const string& startTime, const string& endTime, int seats);
-    bool isRoomAvailable(const vector<Event>& events, const string& date, const string& startTime, const string& endTime, const string& room);
+    void cancelRegistration();
+    void displayEventsBetweenDates();
+    void addRecurringEvent();
+    string allocateVenue(int day, int startMinute, int endMinute, int seats, const Event* ignore = nullptr);
+    bool isRoomAvailable(int day, int startMinute, int endMinute, const string& room, const Event* ignore = nullptr);
     void deleteEvent();
     void modifyEvent();
-    void displayEventsTable(const vector<Event>& events, const map<string, int>& participantCount);
-    bool isValidDateFormat(const string &date);
+    // Which slice of a listing to show and in what order. `sort` is empty
+    // (stored order), "date", "start", "venue" or "fill" (fullest first).
+    struct Listing {
+        string sort;
+        size_t offset = 0;
+        size_t limit = SIZE_MAX;
+    };
+    static const size_t PAGE_SIZE = 20;
+    static Listing parseListing(const vector<string>& fields, size_t first);
+    static string askSortOrder();
+    // The page of results, copied into a table of its own; the matches
+    // outside the page are only ever row numbers. Recurring series are
+    // listed as their occurrences.
+    EventTable selectEvents(const EventStore::Query& query, const Listing& listing);
+    void pageThrough(const EventStore::Query& query, const string& sort, Stats::Operation operation,
+                     const string& emptyMessage);
+    // Erased rows are left out.
+    void displayEventsTable(const EventTable& events);
+    static bool isValidDateFormat(const string &date);
     bool isEventNameUnique(const string& eventName);
+    static bool isValidCategory(const string& category);
+
+    // Prompt-free operations shared by batch mode. They use the same
+    // validation and allocation as the menus and throw invalid_argument.
+    Event prepareEvent(const string& name, const string& organizer, const string& category, const string& date,
+                       string startTime, string endTime, int seats);
+    Event scheduleEvent(const string& name, const string& organizer, const string& category, const string& date,
+                        string startTime, string endTime, int seats);
+    Event planChange(const Event& current, const vector<pair<string, string>>& changes);
+    Event changeEvent(const string& eventName, const vector<pair<string, string>>& changes);
+    // Validates a recurring event; `repeat` is "weekly" or "biweekly" and
+    // `end` is "until=YYYY-MM-DD" or "count=N".
+    EventSeries prepareSeries(const string& name, const string& organizer, const string& category, const string& date,
+                              const string& startTime, const string& endTime, int seats, const string& repeat,
+                              const string& end);
+    EventSeries scheduleSeries(const EventSeries& prepared);
+    static const int MAX_SLOT_SEARCH_DAYS = 366;
+    // Earliest places an event of this size and length could go, searching
+    // from `firstDay` to `lastDay`.
+    vector<EventStore::FreeSlot> findSlots(int seats, int durationMinutes, int firstDay, int lastDay, size_t limit);
+    // An event or series that participants can register for, or nullptr.
+    optional<Event> registrable(const string& name) const;
+    RegistrationIndex::Outcome enrolParticipant(const Participant& participant);
+    RegistrationIndex::Cancellation withdrawParticipant(const string& eventName, const string& rollNumber);
+    static vector<string> splitCommand(const string& line);
+    static vector<pair<string, string>> parseChanges(const vector<string>& fields);
+    string runBatchCommand(const vector<string>& fields, size_t lineNo);
+    int runBatchAdds(const vector<pair<size_t, vector<string>>>& adds, ostream& out);
+
+    // Server mode. Queries share storeLock. Writers take it exclusively only
+    // for the instant they apply a change. Allocation is checked under the
+    // shared lock while holding the stripe lock for the event's date, so two
+    // clients can never book the same room on the same day, and allocations
+    // on different days go ahead in parallel. A series holds the stripes of
+    // all its dates.
+    static const size_t DAY_LOCK_STRIPES = 64;
+    mutex& dayLock(int day);
+    string serveCommand(const vector<string>& fields, size_t requestNo);
+    void serveClient(int fd);
+
+    EventStore store;
+    RegistrationIndex registrations;
+    VenueCatalogue venues;
+    chrono::milliseconds allocationBudget{200};
+    shared_mutex storeLock;
+    array<mutex, DAY_LOCK_STRIPES> dayLocks;
 };
 
-int main() {
-    cout << endl;
-    EventManagementSystem::printHeader("Welcome to OPTIMAL EVENT SCHEDULER");
+// Writes synthetic events and participants files of a chosen size for
+// benchmarking. Events are spread over `days` days from `firstDay`, keep
+// to 15-minute slots in working hours and never overlap in a room.
+// Organizers are drawn from a small pool, as they are in real data.
+// Registrations go to random events.
+class WorkloadGenerator {
+public:
+    struct Options {
+        size_t events = 1000;
+        size_t participants = 0;  // 0 means 3 per event
+        int days = 0;             // 0 means enough days for the rooms to be ~75% full
+        int firstDay = DateTimeParser::toDayNumber({2024, 1, 1});
+        uint64_t seed = 42;
+    };
 
-    EventManagementSystem system;
-    system.run();
-    return 0;
-}
+    static void generate(const string& eventsPath, const string& participantsPath, const VenueCatalogue& venues,
+                         const Options& options);
+};
 
-// Event class definitions
-Event::Event() = default;
-Event::Event(string n, string o, string c, string d, string st, string et, int s, string v)
-    : name(n), organizer(o), category(c), date(d), startTime(st), endTime(et), seats(s), venue(v) {}
+// Benchmarks run from the command line with --bench. "validators" is a
+// micro-benchmark; "suite" times the main operations against generated data
+// from 1k rows up to the given maximum and reports ops/sec and latency
+// percentiles, as a baseline for performance changes.
+class Benchmarks {
+public:
+    static int run(const string& which, int iterations);
 
-string Event::getName() const { return name; }
-string Event::getOrganizer() const { return organizer; }
-string Event::getCategory() const { return category; }
-string Event::getDate() const { return date; }
-string Event::getStartTime() const { return startTime; }
-string Event::getEndTime() const { return endTime; }
-string Event::getVenue() const { return venue; }
-int Event::getSeats() const { return seats; }
+private:
+    static void validators(int iterations);
+    static void suite(size_t maxRows);
+    static void report(const string& operation, size_t rows, vector<double>& nanos);
+};
 
-void Event::save() const {
-    ofstream file("events.txt", ios::app);
-    if (file.is_open()) {
-        file << name << "," << organizer << "," << category << "," 
-             << date << "," << startTime << "," << endTime << "," 
-             << seats << "," << venue << endl;
-        file.close();
-    } else {
-       // cerr << "Unable to open file to save event." << endl;
-    }
-}
+// Checks the data files for problems the program never creates itself but
+// hand edits, older versions or two instances writing at once can leave
+// behind. Run with --audit; the report has one tab-separated line per
+// problem:
+//
+//   overlap    VENUE DATE EVENT START-END EVENT START-END
+//   capacity   EVENT DATE VENUE SEATS ROOM CAPACITY
+//   venue      EVENT DATE VENUE            (room not in the catalogue)
+//   overbooked EVENT REGISTERED SEATS
+//   orphan     FILE:LINE EVENT ROLL NUMBER (no such event or series)
+//   duplicate  FILE:LINE EVENT ROLL NUMBER
+//   malformed  FILE:LINE
+//
+// Bookings, series occurrences included, are sorted by venue, date and start
+// and swept once, keeping a heap of the bookings still running, so the cost
+// is O(n log n) plus one line per overlapping pair. Registrations are read
+// in one streaming pass. run() returns 2 if anything was reported.
+class Auditor {
+public:
+    static int run(const string& eventsPath, const string& participantsPath, const VenueCatalogue& venues, ostream& out);
 
-vector<Event> Event::loadAll() {
-    vector<Event> events;
-    ifstream file("events.txt");
-    if (file.is_open()) {
-        string line;
-        while (getline(file, line)) {
-            size_t pos = 0;
-            string n, o, c, d, st, et, v;
-            int s;
+private:
+    struct Booking {
+        uint32_t venueRank;  // venues in name order
+        int32_t day, startMinute, endMinute;
+        uint32_t source;     // row in the table, or index of the series
+        int32_t occurrence;  // -1 for a table row
+    };
 
-            try {
-                pos = line.find(",");
-                n = line.substr(0, pos); line.erase(0, pos + 1);
-                pos = line.find(",");
-                o = line.substr(0, pos); line.erase(0, pos + 1);
-                pos = line.find(",");
-                c = line.substr(0, pos); line.erase(0, pos + 1);
-                pos = line.find(",");
-                d = line.substr(0, pos); line.erase(0, pos + 1);
-                pos = line.find(",");
-                st = line.substr(0, pos); line.erase(0, pos + 1);
-                pos = line.find(",");
-                et = line.substr(0, pos); line.erase(0, pos + 1);
-                pos = line.find(",");
-                s = stoi(line.substr(0, pos)); line.erase(0, pos + 1);
-                v = line;
-
-                events.emplace_back(n, o, c, d, st, et, s, v);
-            } catch (const exception& e) {
-                cerr << "Error parsing event data: " << e.what() << endl;
-            }
+    static size_t checkBookings(const EventStore& store, const VenueCatalogue& venues, ostream& out);
+    static size_t checkRegistrations(const EventStore& store, const string& participantsPath, ostream& out);
+};
+
+int main(int argc, char* argv[]) {
+    string eventsPath = "events.txt";
+    string participantsPath = "participants.txt";
+    string venuesPath = "venues.txt";
+    string batchPath;
+    string socketPath;
+    string connectPath;
+    string benchWhich;
+    int benchIterations = 0;
+    string convertFrom, convertTo;
+    int budgetMs = 200;
+    bool compactOnly = false;
+    bool audit = false;
+    bool generate = false;
+    WorkloadGenerator::Options workload;
+    bool showStats = false;
+    int statsInterval = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--events" && i + 1 < argc) {
+            eventsPath = argv[++i];
+        } else if (arg == "--participants" && i + 1 < argc) {
+            participantsPath = argv[++i];
+        } else if (arg == "--venues" && i + 1 < argc) {
+            venuesPath = argv[++i];
+        } else if (arg == "--generate" && i + 1 < argc) {
+            generate = true;
+            workload.events = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--registrations" && i + 1 < argc) {
+            workload.participants = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--days" && i + 1 < argc) {
+            workload.days = atoi(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            workload.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batchPath = argv[++i];
+        } else if (arg == "--budget-ms" && i + 1 < argc) {
+            budgetMs = atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            ChunkedParser::setThreads(max(0, atoi(argv[++i])));
+        } else if (arg == "--bench" && i + 1 < argc) {
+            benchWhich = argv[++i];
+            benchIterations = (i + 1 < argc && isdigit(argv[i + 1][0])) ? atoi(argv[++i]) : 0;
+        } else if (arg == "--serve" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--connect" && i + 1 < argc) {
+            connectPath = argv[++i];
+        } else if (arg == "--stats") {
+            showStats = true;
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            statsInterval = atoi(argv[++i]);
+        } else if (arg == "--compact") {
+            compactOnly = true;
+        } else if (arg == "--audit") {
+            audit = true;
+        } else if (arg == "--convert" && i + 2 < argc) {
+            convertFrom = argv[++i];
+            convertTo = argv[++i];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--events FILE] [--participants FILE] [--venues FILE]\n"
+                 << "           [--stats] [--stats-interval SECONDS] [--threads N]\n"
+                 << "           [--compact | --audit | --batch FILE [--budget-ms N] | --serve SOCKET]\n"
+                 << "       " << argv[0] << " --connect SOCKET\n"
+                 << "       " << argv[0] << " --convert FROM TO\n"
+                 << "       " << argv[0] << " --generate EVENTS [--registrations N] [--days D] [--seed S]\n"
+                 << "       " << argv[0] << " --bench validators [ITERATIONS] | --bench suite [MAX ROWS]\n"
+                 << "A FILE ending in .bin uses the binary event format; --batch - reads commands from stdin." << endl;
+            return 1;
         }
-        file.close();
-    } else {
-       // cerr << "Unable to open file to load events." << endl;
     }
-    return events;
-}
 
-void Event::display() const {
-    cout << "+---------------------------------------+\n";
-    cout << "| Event Name: " << name << "\n| Organizer: " << organizer << "\n| Category: " << category 
-         << "\n| Date: " << date << "\n| Time: " << startTime << " - " << endTime 
-         << "\n| Venue: " << venue << "\n| Seats: " << seats << endl;
-    cout << "+---------------------------------------+" << endl;
-}
+    // Declared before any EventManagementSystem so the final dump includes
+    // the writes made when the system shuts down.
+    StatsReporter statsReporter(showStats, statsInterval);
 
-// Participant class definitions
-Participant::Participant() = default;
-Participant::Participant(string n, string r, string d, string p, string e)
-    : name(n), rollNumber(r), department(d), phoneNumber(p), eventName(e) {}
+    if (!benchWhich.empty()) {
+        return Benchmarks::run(benchWhich, benchIterations);
+    }
 
-void Participant::save() const {
-    ofstream file("participants.txt", ios::app);
-    if (file.is_open()) {
-        file << name << "," << rollNumber << "," 
-             << department << "," << phoneNumber << "," 
-             << eventName << endl;
-        file.close();
-    } else {
-       // cerr << "Unable to open file to save participant." << endl;
+    if (!connectPath.empty()) {
+        return EventManagementSystem::connect(connectPath);
     }
-}
 
-map<string, int> Participant::countByEvent() {
-    map<string, int> participantCount;
-    ifstream file("participants.txt");
-    if (file.is_open()) {
-        string line;
-        while (getline(file, line)) {
-            size_t pos = line.rfind(",");
-            string eventName = line.substr(pos + 1);
-            participantCount[eventName]++;
+    if (!convertFrom.empty()) {
+        try {
+            EventBinaryFile::convert(convertFrom, convertTo);
+            return 0;
+        } catch (const exception& e) {
+            cerr << e.what() << endl;
+            return 1;
         }
-        file.close();
-    } else {
-     //   cerr << "Unable to open file to load participants." << endl;
     }
-    return participantCount;
-}
 
-// EventManagementSystem class definitions
-void EventManagementSystem::run() {
-    while (true) {
-        try {
-            int role;
-            cout << "\n1. Are you an Organizer?\n2. Are you a Participant?\n0. Exit\nEnter your choice: ";
-            cin >> role;
-            cout << endl;
-            if (cin.fail()) {
-                cin.clear();
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                throw invalid_argument("Invalid input. Please enter a number.");
-            }
+    if (generate) {
+        WorkloadGenerator::generate(eventsPath, participantsPath, VenueCatalogue::load(venuesPath), workload);
+        return 0;
+    }
 
-            switch (role) {
-                case 1:
-                    organizerMenu();
-                    break;
-                case 2:
-                    participantMenu();
-                    break;
-                case 0:
-                    return;
-                default:
-                    throw invalid_argument("Invalid choice. Please enter 0, 1, or 2.");
+    if (!batchPath.empty()) {
+        ifstream file;
+        if (batchPath != "-") {
+            file.open(batchPath);
+            if (!file.is_open()) {
+                cerr << "Unable to open " << batchPath << "." << endl;
+                return 1;
             }
-        } catch (const invalid_argument& e) {
-            cerr << e.what() << endl;
         }
+        EventManagementSystem system(eventsPath, participantsPath, venuesPath);
+        system.setAllocationBudget(chrono::milliseconds(budgetMs));
+        return system.runBatch(batchPath == "-" ? cin : file, cout);
     }
-}
 
-void EventManagementSystem::validateDate(const string& date) {
-    regex datePattern(R"(\d{4}-\d{2}-\d{2})");
-    if (!regex_match(date, datePattern)) {
-        throw invalid_argument("Invalid date format. Please enter the date in YYYY-MM-DD format.");
+    if (!socketPath.empty()) {
+        EventManagementSystem system(eventsPath, participantsPath, venuesPath);
+        return system.serve(socketPath);
     }
 
-    int year = stoi(date.substr(0, 4));
-    int month = stoi(date.substr(5, 2));
-    int day = stoi(date.substr(8, 2));
-
-    if (year < 1900 || year > 2100) {
-        throw invalid_argument("Invalid year. Year must be between 1900 and 2100.");
+    if (audit) {
+        return Auditor::run(eventsPath, participantsPath, VenueCatalogue::load(venuesPath), cout);
     }
-    if (month < 1 || month > 12) {
-        throw invalid_argument("Invalid month. Month must be between 01 and 12.");
+
+    if (compactOnly) {
+        EventStore store(eventsPath);
+        store.load();
+        store.compact();
+        return 0;
     }
 
-    if ((month == 1 || month == 3 || month == 5 || month == 7 || month == 8 || month == 10 || month == 12) && (day < 1 || day > 31)) {
-        throw invalid_argument("Invalid day. Day must be between 01 and 31.");
-    } else if ((month == 4 || month == 6 || month == 9 || month == 11) && (day < 1 || day > 30)) {
-        throw invalid_argument("Invalid day. Day must be between 01 and 30.");
-    } else if (month == 2) {
-        bool isLeapYear = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-        if ((isLeapYear && (day < 1 || day > 29)) || (!isLeapYear && (day < 1 || day > 28))) {
-            throw invalid_argument("Invalid day. Day must be between 01 and 29 in a leap year and between 01 and 28 otherwise.");
-        }
+    cout << endl;
+    EventManagementSystem::printHeader("Welcome to OPTIMAL EVENT SCHEDULER");
+
+    EventManagementSystem system(eventsPath, participantsPath, venuesPath);
+    system.run();
+    return 0;
+}
+
+// FileStamp definitions
+FileStamp FileStamp::of(const string& path) {
+    FileStamp stamp;
+    struct stat info;
+    if (stat(path.c_str(), &info) == 0) {
+        stamp.size = info.st_size;
+#ifdef _WIN32
+        stamp.mtimeNs = int64_t(info.st_mtime) * 1000000000;
+#else
+        stamp.mtimeNs = int64_t(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
     }
+    return stamp;
 }
 
-void EventManagementSystem::validateTime(const string& startTime, const string& endTime) {
-    regex timePattern(R"((1[0-9]|2[0-3]|0?[0-9]):([0-5][0-9]))");
-    smatch matchStart, matchEnd;
-    if (regex_match(startTime, matchStart, timePattern) && regex_match(endTime, matchEnd, timePattern)) {
-        int startHour = stoi(matchStart[1].str());
-        int endHour = stoi(matchEnd[1].str());
-        int startMinute = stoi(matchStart[2].str());
-        int endMinute = stoi(matchEnd[2].str());
+bool FileStamp::operator==(const FileStamp& other) const {
+    return size == other.size && mtimeNs == other.mtimeNs;
+}
 
-        if (startHour < 8 || startHour >= 16) {
-            throw invalid_argument("Please select a start time between 08:00 and 16:00.");
-        }
-        if (endHour < 8 || endHour >= 16 || (endHour == 16 && endMinute > 0)) {
-            throw invalid_argument("Please select an end time between 08:00 and 16:00.");
+bool FileStamp::operator!=(const FileStamp& other) const { return !(*this == other); }
+
+// Stats class definitions
+const char* const Stats::names[OPERATION_COUNT] = {"load", "add", "modify", "delete", "register", "allocate", "optimize",
+                                                   "display_all", "display_category", "display_organizer", "display_range", "query"};
+Stats::Histogram Stats::histograms[OPERATION_COUNT];
+atomic<uint64_t> Stats::bytesRead{0};
+atomic<uint64_t> Stats::bytesWritten{0};
+atomic<uint64_t> Stats::eventsParses{0};
+atomic<uint64_t> Stats::participantsParses{0};
+const chrono::steady_clock::time_point Stats::started = chrono::steady_clock::now();
+
+Stats::Timer::Timer(Operation op) : operation(op), start(chrono::steady_clock::now()) {}
+
+Stats::Timer::~Timer() {
+    record(operation, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+}
+
+void Stats::record(Operation op, uint64_t nanos) {
+    Histogram& histogram = histograms[op];
+    int bucket = 0;
+    while (bucket + 1 < BUCKETS && (uint64_t(1) << bucket) < nanos) ++bucket;
+    histogram.buckets[bucket].fetch_add(1, memory_order_relaxed);
+    histogram.totalNanos.fetch_add(nanos, memory_order_relaxed);
+    uint64_t seen = histogram.maxNanos.load(memory_order_relaxed);
+    while (nanos > seen && !histogram.maxNanos.compare_exchange_weak(seen, nanos, memory_order_relaxed)) {
+    }
+    histogram.count.fetch_add(1, memory_order_relaxed);
+}
+
+void Stats::addBytesRead(uint64_t bytes) { bytesRead.fetch_add(bytes, memory_order_relaxed); }
+void Stats::addBytesWritten(uint64_t bytes) { bytesWritten.fetch_add(bytes, memory_order_relaxed); }
+void Stats::countEventsParse() { eventsParses.fetch_add(1, memory_order_relaxed); }
+void Stats::countParticipantsParse() { participantsParses.fetch_add(1, memory_order_relaxed); }
+
+double Stats::percentileMicros(const Histogram& histogram, uint64_t count, double fraction) {
+    uint64_t rank = max<uint64_t>(1, uint64_t(fraction * count + 0.5)), seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += histogram.buckets[bucket].load(memory_order_relaxed);
+        if (seen >= rank) {
+            return min(uint64_t(1) << bucket, histogram.maxNanos.load(memory_order_relaxed)) / 1000.0;
         }
-        if (endHour < startHour || (endHour == startHour && endMinute <= startMinute)) {
-            throw invalid_argument("End time must be after start time.");
+    }
+    return histogram.maxNanos.load(memory_order_relaxed) / 1000.0;
+}
+
+string Stats::line() {
+    ostringstream out;
+    out << fixed << setprecision(1) << "stats uptime_s="
+        << chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+        const Histogram& histogram = histograms[op];
+        uint64_t count = histogram.count.load(memory_order_relaxed);
+        out << ' ' << names[op] << ".count=" << count;
+        if (count == 0) continue;
+        out << ' ' << names[op] << ".p50_us=" << percentileMicros(histogram, count, 0.50)
+            << ' ' << names[op] << ".p99_us=" << percentileMicros(histogram, count, 0.99)
+            << ' ' << names[op] << ".max_us=" << histogram.maxNanos.load(memory_order_relaxed) / 1000.0;
+    }
+    out << " bytes_read=" << bytesRead.load() << " bytes_written=" << bytesWritten.load()
+        << " events_parses=" << eventsParses.load() << " participants_parses=" << participantsParses.load();
+    return out.str();
+}
+
+void Stats::dump(ostream& out) {
+    out << left << setw(20) << "operation" << right << setw(10) << "count" << setw(12) << "total ms"
+        << setw(12) << "p50 us" << setw(12) << "p90 us" << setw(12) << "p99 us" << setw(12) << "max us" << '\n';
+    out << fixed << setprecision(1);
+    for (int op = 0; op < OPERATION_COUNT; ++op) {
+        const Histogram& histogram = histograms[op];
+        uint64_t count = histogram.count.load(memory_order_relaxed);
+        if (count == 0) continue;
+        out << left << setw(20) << names[op] << right << setw(10) << count
+            << setw(12) << histogram.totalNanos.load(memory_order_relaxed) / 1e6
+            << setw(12) << percentileMicros(histogram, count, 0.50) << setw(12) << percentileMicros(histogram, count, 0.90)
+            << setw(12) << percentileMicros(histogram, count, 0.99)
+            << setw(12) << histogram.maxNanos.load(memory_order_relaxed) / 1000.0 << '\n';
+    }
+    out << "bytes read: " << bytesRead.load() << ", bytes written: " << bytesWritten.load()
+        << ", events file parses: " << eventsParses.load()
+        << ", participants file parses: " << participantsParses.load() << endl;
+}
+
+// StatsReporter class definitions
+StatsReporter::StatsReporter(bool d, int intervalSeconds) : dumpOnExit(d) {
+    if (intervalSeconds <= 0) return;
+    ticker = thread([this, intervalSeconds]() {
+        unique_lock<mutex> guard(lock);
+        while (!wake.wait_for(guard, chrono::seconds(intervalSeconds), [this]() { return stopping; })) {
+            cerr << Stats::line() << endl;
+        }
+    });
+}
+
+StatsReporter::~StatsReporter() {
+    if (ticker.joinable()) {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        ticker.join();
+    }
+    if (dumpOnExit) {
+        Stats::dump(cerr);
+        cerr << Stats::line() << endl;
+    }
+}
+
+// DateTimeParser class definitions
+bool DateTimeParser::parseDate(string_view text, DateParts& out) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    int values[3] = {0, 0, 0};
+    static const int starts[3] = {0, 5, 8};
+    static const int widths[3] = {4, 2, 2};
+    for (int part = 0; part < 3; ++part) {
+        for (int i = 0; i < widths[part]; ++i) {
+            unsigned digit = unsigned(text[starts[part] + i]) - '0';
+            if (digit > 9) return false;
+            values[part] = values[part] * 10 + int(digit);
+        }
+    }
+    out.year = values[0];
+    out.month = values[1];
+    out.day = values[2];
+    return true;
+}
+
+bool DateTimeParser::parseTime(string_view text, TimeParts& out) {
+    size_t colon = text.size() == 4 ? 1 : text.size() == 5 ? 2 : 0;
+    if (colon == 0 || text[colon] != ':') return false;
+
+    unsigned h1 = unsigned(text[0]) - '0';
+    if (h1 > 9) return false;
+    int hour = h1;
+    if (colon == 2) {
+        unsigned h2 = unsigned(text[1]) - '0';
+        if (h2 > 9 || h1 > 2 || (h1 == 2 && h2 > 3)) return false;
+        hour = hour * 10 + int(h2);
+    }
+
+    unsigned m1 = unsigned(text[colon + 1]) - '0';
+    unsigned m2 = unsigned(text[colon + 2]) - '0';
+    if (m1 > 5 || m2 > 9) return false;
+    out.hour = hour;
+    out.minute = int(m1 * 10 + m2);
+    return true;
+}
+
+int DateTimeParser::daysInMonth(int year, int month) {
+    static const int days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12) return 0;
+    bool isLeapYear = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+    return month == 2 && isLeapYear ? 29 : days[month - 1];
+}
+
+// Civil-calendar conversion after Howard Hinnant's days_from_civil.
+int DateTimeParser::toDayNumber(const DateParts& date) {
+    int year = date.year - (date.month <= 2);
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (date.month + (date.month > 2 ? -3 : 9)) + 2) / 5 + date.day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+DateParts DateTimeParser::fromDayNumber(int day) {
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int dayOfEra = day - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shiftedMonth = (5 * dayOfYear + 2) / 153;
+    DateParts date;
+    date.day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    date.month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    date.year = yearOfEra + era * 400 + (date.month <= 2);
+    return date;
+}
+
+int DateTimeParser::parseDayNumber(string_view text) {
+    DateParts date;
+    if (!parseDate(text, date) || date.day < 1 || date.day > daysInMonth(date.year, date.month)) {
+        throw invalid_argument("Invalid date \"" + string(text) + "\".");
+    }
+    return toDayNumber(date);
+}
+
+int DateTimeParser::parseMinutes(string_view text) {
+    TimeParts time;
+    if (!parseTime(text, time)) {
+        throw invalid_argument("Invalid time \"" + string(text) + "\".");
+    }
+    return time.hour * 60 + time.minute;
+}
+
+string DateTimeParser::formatDate(int day) {
+    DateParts date = fromDayNumber(day);
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d", date.year % 10000, date.month, date.day);
+    return string(buffer);
+}
+
+string DateTimeParser::formatTime(int minutes) {
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", minutes / 60 % 100, minutes % 60);
+    return string(buffer);
+}
+
+// MappedFile class definitions
+#ifndef _WIN32
+MappedFile::MappedFile(const string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<const char*>(mapping);
+            size = info.st_size;
+            Stats::addBytesRead(size);
+            madvise(mapping, size, MADV_SEQUENTIAL);
         }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) munmap(const_cast<char*>(data), size);
+}
+#else
+MappedFile::MappedFile(const string& path) {
+    ifstream file(path, ios::binary);
+    if (file.is_open()) {
+        buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        data = buffer.data();
+        size = buffer.size();
+        Stats::addBytesRead(size);
+    }
+}
+
+MappedFile::~MappedFile() = default;
+#endif
+
+string_view MappedFile::view() const { return string_view(data, size); }
+
+// FieldScanner class definitions
+FieldScanner::FieldScanner(string_view t) : text(t) {}
+
+bool FieldScanner::nextLine() {
+    if (offset >= text.size()) return false;
+    size_t end = text.find('\n', offset);
+    if (end == string_view::npos) end = text.size();
+    current = text.substr(offset, end - offset);
+    if (!current.empty() && current.back() == '\r') current.remove_suffix(1);  // files edited on Windows
+    offset = end + 1;
+    ++lineNo;
+    return true;
+}
+
+string_view FieldScanner::line() const { return current; }
+size_t FieldScanner::lineNumber() const { return lineNo; }
+
+bool FieldScanner::split(string_view* fields, size_t count) const {
+    size_t start = 0;
+    for (size_t i = 0; i + 1 < count; ++i) {
+        size_t comma = current.find(',', start);
+        if (comma == string_view::npos) return false;
+        fields[i] = current.substr(start, comma - start);
+        start = comma + 1;
+    }
+    fields[count - 1] = current.substr(start);
+    return true;
+}
+
+bool FieldScanner::toInt(string_view field, int& value) {
+    while (!field.empty() && field.front() == ' ') field.remove_prefix(1);
+    while (!field.empty() && field.back() == ' ') field.remove_suffix(1);
+    auto result = from_chars(field.data(), field.data() + field.size(), value);
+    return result.ec == errc() && result.ptr == field.data() + field.size();
+}
+
+// ChunkedParser class definitions
+atomic<unsigned> ChunkedParser::threadCount{0};
+
+void ChunkedParser::setThreads(unsigned count) { threadCount = count; }
+
+unsigned ChunkedParser::threads() {
+    unsigned count = threadCount;
+    return count > 0 ? count : max(1u, thread::hardware_concurrency());
+}
+
+vector<string_view> ChunkedParser::split(string_view text) {
+    vector<string_view> chunks;
+    size_t parts = max<size_t>(1, min<size_t>(threads(), text.size() / MIN_CHUNK_BYTES));
+    size_t start = 0;
+    for (size_t i = 1; i <= parts && start < text.size(); ++i) {
+        size_t end = i == parts ? text.size() : text.find('\n', max(start, text.size() * i / parts));
+        end = end == string_view::npos ? text.size() : end + 1;  // each chunk keeps its final newline
+        chunks.push_back(text.substr(start, end - start));
+        start = end;
+    }
+    return chunks;
+}
+
+void ChunkedParser::run(const vector<string_view>& chunks, const function<void(size_t, string_view)>& parse) {
+    if (chunks.size() == 1) {
+        parse(0, chunks[0]);
+        return;
+    }
+    vector<thread> workers;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        workers.emplace_back([&parse, &chunks, i]() { parse(i, chunks[i]); });
+    }
+    for (auto& worker : workers) worker.join();
+}
+
+// StringPool class definitions
+StringPool::Table& StringPool::table() {
+    static Table instance;
+    return instance;
+}
+
+uint32_t StringPool::intern(string_view text) {
+    Table& t = table();
+    {
+        shared_lock<shared_mutex> read(t.lock);
+        auto it = t.ids.find(text);
+        if (it != t.ids.end()) return it->second;
+    }
+    unique_lock<shared_mutex> write(t.lock);
+    auto it = t.ids.find(text);
+    if (it != t.ids.end()) return it->second;
+    uint32_t id = t.strings.size();
+    t.strings.emplace_back(text);
+    t.ids.emplace(t.strings.back(), id);  // deque elements never move
+    return id;
+}
+
+bool StringPool::find(string_view text, uint32_t& id) {
+    Table& t = table();
+    shared_lock<shared_mutex> read(t.lock);
+    auto it = t.ids.find(text);
+    if (it == t.ids.end()) return false;
+    id = it->second;
+    return true;
+}
+
+const string& StringPool::lookup(uint32_t id) {
+    Table& t = table();
+    shared_lock<shared_mutex> read(t.lock);
+    return t.strings[id];
+}
+
+// Event class definitions
+static const string categoryNames[Event::CATEGORY_COUNT] = {"Workshop", "Seminar", "Lecture", "Exam", "Formal Event",
+                                                            "Miscellaneous"};
+
+Event::Category Event::parseCategory(string_view text) {
+    for (int i = 0; i < CATEGORY_COUNT; ++i) {
+        if (text == categoryNames[i]) return Category(i);
+    }
+    throw invalid_argument("Invalid category \"" + string(text) + "\".");
+}
+
+bool Event::isCategory(string_view text) {
+    return std::find(begin(categoryNames), end(categoryNames), text) != end(categoryNames);
+}
+
+const string& Event::categoryName(Category category) { return categoryNames[int(category)]; }
+
+Event::Event() = default;
+Event::Event(string n, string o, string c, string d, string st, string et, int s, string v)
+    : name(move(n)), organizer(StringPool::intern(o)), venue(StringPool::intern(v)), category(parseCategory(c)),
+      day(DateTimeParser::parseDayNumber(d)), startMinute(DateTimeParser::parseMinutes(st)),
+      endMinute(DateTimeParser::parseMinutes(et)), seats(s) {}
+
+Event::Event(string n, string o, string c, int d, int st, int et, int s, string v)
+    : name(move(n)), organizer(StringPool::intern(o)), venue(StringPool::intern(v)), category(parseCategory(c)),
+      day(d), startMinute(st), endMinute(et), seats(s) {}
+
+string Event::getName() const { return name; }
+const string& Event::getOrganizer() const { return StringPool::lookup(organizer); }
+const string& Event::getCategory() const { return categoryName(category); }
+uint32_t Event::getOrganizerId() const { return organizer; }
+Event::Category Event::getCategoryId() const { return category; }
+uint32_t Event::getVenueId() const { return venue; }
+string Event::getDate() const { return DateTimeParser::formatDate(day); }
+string Event::getStartTime() const { return DateTimeParser::formatTime(startMinute); }
+string Event::getEndTime() const { return DateTimeParser::formatTime(endMinute); }
+int Event::getDay() const { return day; }
+int Event::getStartMinute() const { return startMinute; }
+int Event::getEndMinute() const { return endMinute; }
+const string& Event::getVenue() const { return StringPool::lookup(venue); }
+int Event::getSeats() const { return seats; }
+
+void Event::save(const string& path) const {
+    ofstream file(path, ios::app);
+    if (file.is_open()) {
+        string record = name + "," + getOrganizer() + "," + getCategory() + "," + getDate() + "," + getStartTime() + ","
+                      + getEndTime() + "," + to_string(seats) + "," + getVenue() + "\n";
+        file << record << flush;
+        file.close();
+        Stats::addBytesWritten(record.size());
     } else {
-        throw invalid_argument("Invalid time format. Please enter time in HH:MM format.");
+       // cerr << "Unable to open file to save event." << endl;
+    }
+}
+
+// Chunks are parsed in parallel; errors are collected per chunk and reported
+// afterwards with their line numbers in the whole file.
+EventTable Event::loadAll(const string& path, size_t* skipped) {
+    Stats::countEventsParse();
+    MappedFile file(path);
+    vector<string_view> chunks = ChunkedParser::split(file.view());
+    vector<EventTable> parts(chunks.size());
+    vector<vector<pair<size_t, string>>> errors(chunks.size());
+    vector<size_t> lineCounts(chunks.size());
+
+    ChunkedParser::run(chunks, [&](size_t chunk, string_view text) {
+        EventTable& events = parts[chunk];
+        events.reserve(text.size() / 64, text.size() / 4);  // typical line and name lengths
+        FieldScanner scanner(text);
+        auto fail = [&](const string& message) { errors[chunk].emplace_back(scanner.lineNumber(), message); };
+        string_view f[8];
+        while (scanner.nextLine()) {
+            if (scanner.line().empty()) continue;
+            int s;
+            if (!scanner.split(f, 8)) {
+                fail("expected 8 fields");
+                continue;
+            }
+            if (!FieldScanner::toInt(f[6], s)) {
+                fail("invalid seat count \"" + string(f[6]) + "\"");
+                continue;
+            }
+            DateParts d;
+            TimeParts st, et;
+            if (!DateTimeParser::parseDate(f[3], d) || d.day < 1 || d.day > DateTimeParser::daysInMonth(d.year, d.month)) {
+                fail("invalid date \"" + string(f[3]) + "\"");
+                continue;
+            }
+            if (!DateTimeParser::parseTime(f[4], st) || !DateTimeParser::parseTime(f[5], et)) {
+                fail("invalid time");
+                continue;
+            }
+            if (!Event::isCategory(f[2])) {
+                fail("invalid category \"" + string(f[2]) + "\"");
+                continue;
+            }
+            events.append(f[0], StringPool::intern(f[1]), parseCategory(f[2]), DateTimeParser::toDayNumber(d),
+                          st.hour * 60 + st.minute, et.hour * 60 + et.minute, s, StringPool::intern(f[7]));
+        }
+        lineCounts[chunk] = scanner.lineNumber();
+    });
+
+    EventTable events;
+    size_t firstLine = 0;
+    for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+        for (const auto& error : errors[chunk]) {
+            cerr << "Error parsing event data: " << path << ":" << firstLine + error.first << ": " << error.second << endl;
+        }
+        if (skipped != nullptr) *skipped += errors[chunk].size();
+        firstLine += lineCounts[chunk];
+        if (chunk == 0) {
+            events = move(parts[0]);
+        } else {
+            events.append(parts[chunk]);
+        }
+    }
+    return events;
+}
+
+void Event::saveAll(const EventTable& events, const string& path) {
+    ofstream file(path);
+    if (file.is_open()) {
+        for (size_t i = 0; i < events.size(); ++i) {
+            if (events.isErased(i)) continue;
+            file << events.name(i) << "," << StringPool::lookup(events.organizer(i)) << ","
+                 << categoryName(events.category(i)) << "," << DateTimeParser::formatDate(events.day(i)) << ","
+                 << DateTimeParser::formatTime(events.startMinute(i)) << ","
+                 << DateTimeParser::formatTime(events.endMinute(i)) << "," << events.seats(i) << ","
+                 << StringPool::lookup(events.venue(i)) << "\n";
+        }
+        Stats::addBytesWritten(file.tellp());
+        file.close();
+    } else {
+       // cerr << "Unable to open file to save events." << endl;
+    }
+}
+
+void Event::display() const {
+    cout << "+---------------------------------------+\n";
+    cout << "| Event Name: " << name << "\n| Organizer: " << getOrganizer() << "\n| Category: " << getCategory()
+         << "\n| Date: " << getDate() << "\n| Time: " << getStartTime() << " - " << getEndTime()
+         << "\n| Venue: " << getVenue() << "\n| Seats: " << seats << endl;
+    cout << "+---------------------------------------+" << endl;
+}
+
+// EventTable class definitions
+size_t EventTable::size() const { return days.size(); }
+size_t EventTable::liveRows() const { return days.size() - erasedRows; }
+bool EventTable::empty() const { return liveRows() == 0; }
+bool EventTable::isErased(size_t row) const { return erasedFlags[row] != 0; }
+
+void EventTable::reserve(size_t rows, size_t nameBytes) {
+    for (auto* column : {&days, &startMinutes, &endMinutes, &seatCounts}) column->reserve(rows);
+    organizers.reserve(rows);
+    venues.reserve(rows);
+    categories.reserve(rows);
+    nameOffsets.reserve(rows);
+    nameLengths.reserve(rows);
+    erasedFlags.reserve(rows);
+    arena.reserve(nameBytes);
+}
+
+void EventTable::append(string_view name, uint32_t organizer, Event::Category category, int day, int startMinute,
+                        int endMinute, int seats, uint32_t venue) {
+    nameOffsets.push_back(arena.size());
+    nameLengths.push_back(name.size());
+    arena.append(name);
+    organizers.push_back(organizer);
+    categories.push_back(category);
+    days.push_back(day);
+    startMinutes.push_back(startMinute);
+    endMinutes.push_back(endMinute);
+    seatCounts.push_back(seats);
+    venues.push_back(venue);
+    erasedFlags.push_back(0);
+}
+
+void EventTable::append(const Event& event) {
+    append(event.name, event.organizer, event.category, event.day, event.startMinute, event.endMinute, event.seats,
+           event.venue);
+}
+
+void EventTable::append(const EventTable& rows, size_t row) {
+    append(rows.name(row), rows.organizers[row], rows.categories[row], rows.days[row], rows.startMinutes[row],
+           rows.endMinutes[row], rows.seatCounts[row], rows.venues[row]);
+}
+
+void EventTable::append(const EventTable& rows) {
+    uint64_t shift = arena.size();
+    arena += rows.arena;
+    garbage += rows.garbage;
+    erasedRows += rows.erasedRows;
+    for (uint64_t offset : rows.nameOffsets) nameOffsets.push_back(offset + shift);
+    auto extend = [](auto& column, const auto& more) { column.insert(column.end(), more.begin(), more.end()); };
+    extend(nameLengths, rows.nameLengths);
+    extend(organizers, rows.organizers);
+    extend(categories, rows.categories);
+    extend(days, rows.days);
+    extend(startMinutes, rows.startMinutes);
+    extend(endMinutes, rows.endMinutes);
+    extend(seatCounts, rows.seatCounts);
+    extend(venues, rows.venues);
+    extend(erasedFlags, rows.erasedFlags);
+}
+
+void EventTable::assign(size_t row, const Event& event) {
+    if (name(row) != event.name) {
+        garbage += nameLengths[row];
+        nameOffsets[row] = arena.size();
+        nameLengths[row] = event.name.size();
+        arena += event.name;
+    }
+    organizers[row] = event.organizer;
+    categories[row] = event.category;
+    days[row] = event.day;
+    startMinutes[row] = event.startMinute;
+    endMinutes[row] = event.endMinute;
+    seatCounts[row] = event.seats;
+    venues[row] = event.venue;
+    if (garbage > arena.size() / 2) repack();
+}
+
+void EventTable::erase(size_t row) {
+    if (erasedFlags[row]) return;
+    erasedFlags[row] = 1;
+    ++erasedRows;
+    garbage += nameLengths[row];
+    nameLengths[row] = 0;
+    if (garbage > arena.size() / 2) repack();
+}
+
+void EventTable::dropErased() {
+    if (erasedRows == 0) return;
+    size_t kept = 0;
+    for (size_t i = 0; i < size(); ++i) {
+        if (erasedFlags[i]) continue;
+        days[kept] = days[i];
+        startMinutes[kept] = startMinutes[i];
+        endMinutes[kept] = endMinutes[i];
+        seatCounts[kept] = seatCounts[i];
+        organizers[kept] = organizers[i];
+        venues[kept] = venues[i];
+        categories[kept] = categories[i];
+        nameOffsets[kept] = nameOffsets[i];
+        nameLengths[kept] = nameLengths[i];
+        ++kept;
+    }
+    for (auto* column : {&days, &startMinutes, &endMinutes, &seatCounts}) column->resize(kept);
+    organizers.resize(kept);
+    venues.resize(kept);
+    categories.resize(kept);
+    nameOffsets.resize(kept);
+    nameLengths.resize(kept);
+    erasedFlags.assign(kept, 0);
+    erasedRows = 0;
+    repack();
+}
+
+void EventTable::repack() {
+    string packed;
+    packed.reserve(arena.size() - garbage);
+    for (size_t i = 0; i < size(); ++i) {
+        string_view text = name(i);  // empty for erased rows
+        nameOffsets[i] = packed.size();
+        packed.append(text);
+    }
+    arena = move(packed);
+    garbage = 0;
+}
+
+Event EventTable::row(size_t row) const {
+    Event event;
+    event.name = string(name(row));
+    event.organizer = organizers[row];
+    event.venue = venues[row];
+    event.category = categories[row];
+    event.day = days[row];
+    event.startMinute = startMinutes[row];
+    event.endMinute = endMinutes[row];
+    event.seats = seatCounts[row];
+    return event;
+}
+
+string_view EventTable::name(size_t row) const {
+    return string_view(arena).substr(nameOffsets[row], nameLengths[row]);
+}
+uint32_t EventTable::organizer(size_t row) const { return organizers[row]; }
+Event::Category EventTable::category(size_t row) const { return categories[row]; }
+int EventTable::day(size_t row) const { return days[row]; }
+int EventTable::startMinute(size_t row) const { return startMinutes[row]; }
+int EventTable::endMinute(size_t row) const { return endMinutes[row]; }
+int EventTable::seats(size_t row) const { return seatCounts[row]; }
+uint32_t EventTable::venue(size_t row) const { return venues[row]; }
+
+// EventNameIndex class definitions
+EventNameIndex::EventNameIndex(const EventTable& t) : table(t) {}
+
+void EventNameIndex::clear() {
+    slots.clear();
+    live = used = 0;
+}
+
+void EventNameIndex::reserve(size_t rows) {
+    if (capacityFor(rows) > slots.size()) rehash(capacityFor(rows));
+}
+
+size_t EventNameIndex::size() const { return live; }
+
+uint32_t EventNameIndex::hashOf(string_view name) {
+    uint32_t h = 2166136261u;
+    for (char c : name) h = (h ^ uint8_t(c)) * 16777619u;
+    return h;
+}
+
+// Room for `rows` at no more than a quarter full, so a rehash is followed
+// by at least as many inserts before the next one.
+size_t EventNameIndex::capacityFor(size_t rows) {
+    size_t capacity = 16;
+    while (capacity < rows * 4) capacity *= 2;
+    return capacity;
+}
+
+size_t EventNameIndex::find(string_view name) const {
+    if (slots.empty()) return npos;
+    uint32_t h = hashOf(name);
+    size_t mask = slots.size() - 1;
+    for (size_t i = h & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.row == EMPTY) return npos;
+        if (slot.row != REMOVED && slot.hash == h && table.name(slot.row) == name) return slot.row;
+    }
+}
+
+void EventNameIndex::insert(size_t row) {
+    if ((used + 1) * 2 > slots.size()) rehash(capacityFor(live + 1));
+    uint32_t h = hashOf(table.name(row));
+    size_t mask = slots.size() - 1;
+    size_t i = h & mask;
+    while (slots[i].row != EMPTY && slots[i].row != REMOVED) i = (i + 1) & mask;
+    if (slots[i].row == EMPTY) ++used;
+    slots[i] = {uint32_t(row), h};
+    ++live;
+}
+
+void EventNameIndex::erase(size_t row) {
+    if (slots.empty()) return;
+    uint32_t h = hashOf(table.name(row));
+    size_t mask = slots.size() - 1;
+    for (size_t i = h & mask; slots[i].row != EMPTY; i = (i + 1) & mask) {
+        if (slots[i].row == row) {
+            slots[i].row = REMOVED;
+            --live;
+            return;
+        }
+    }
+}
+
+void EventNameIndex::rehash(size_t capacity) {
+    vector<Slot> old = move(slots);
+    slots.assign(capacity, {EMPTY, 0});
+    size_t mask = capacity - 1;
+    for (const Slot& slot : old) {
+        if (slot.row == EMPTY || slot.row == REMOVED) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].row != EMPTY) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+    used = live;
+}
+
+// EventBinaryFile class definitions
+bool EventBinaryFile::matches(const string& path) {
+    return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+}
+
+// Reads the whole store, journal included, so the output reflects every edit.
+// Recurring series are copied to the target's own series file.
+void EventBinaryFile::convert(const string& from, const string& to) {
+    EventStore source(from);
+    source.load(true);
+    source.exportTo(to);
+    cout << "Converted " << source.table().liveRows() << " events";
+    if (!source.allSeries().empty()) cout << " and " << source.allSeries().size() << " series";
+    cout << " from " << from << " to " << to << "." << endl;
+}
+
+EventTable EventBinaryFile::load(const string& path, size_t* skipped) {
+    EventTable events;
+    auto unreadable = [&]() {
+        if (skipped != nullptr) ++*skipped;
+        return events;
+    };
+    Stats::countEventsParse();
+    MappedFile file(path);
+    string_view data = file.view();
+    if (data.empty()) return events;
+
+    Header header;
+    if (data.size() < sizeof(header)) {
+        cerr << "Error parsing event data: " << path << ": truncated header" << endl;
+        return unreadable();
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION) {
+        cerr << "Error parsing event data: " << path << ": not a version " << VERSION << " event file" << endl;
+        return unreadable();
+    }
+
+    size_t rows = header.rowCount;
+    size_t expected = sizeof(header) + rows * (4 + 2 + 2 + 4 + 4 * 4)
+                    + (size_t(header.stringCount) + 1) * 4 + header.stringBytes;
+    if (data.size() != expected) {
+        cerr << "Error parsing event data: " << path << ": size does not match header" << endl;
+        return unreadable();
+    }
+
+    const char* cursor = data.data() + sizeof(header);
+    auto column = [&cursor](auto& out, size_t count) {
+        out.resize(count);
+        memcpy(out.data(), cursor, count * sizeof(out[0]));
+        cursor += count * sizeof(out[0]);
+    };
+    vector<int32_t> date, seats;
+    vector<uint16_t> start, end;
+    vector<uint32_t> venue, name, organizer, category, offsets;
+    column(date, rows);
+    column(start, rows);
+    column(end, rows);
+    column(seats, rows);
+    column(venue, rows);
+    column(name, rows);
+    column(organizer, rows);
+    column(category, rows);
+    column(offsets, header.stringCount + 1);
+    const char* strings = cursor;
+
+    auto text = [&](uint32_t id) {
+        if (id >= header.stringCount || offsets[id] > offsets[id + 1] || offsets[id + 1] > header.stringBytes) {
+            return string_view();
+        }
+        return string_view(strings + offsets[id], offsets[id + 1] - offsets[id]);
+    };
+    // Each string in the file is interned at most once.
+    const uint32_t unseen = UINT32_MAX;
+    vector<uint32_t> pooled(header.stringCount, unseen);
+    auto pool = [&](uint32_t id) {
+        if (id >= header.stringCount) return StringPool::intern(string_view());
+        if (pooled[id] == unseen) pooled[id] = StringPool::intern(text(id));
+        return pooled[id];
+    };
+    auto dayNumber = [](int32_t value) {
+        DateParts parts;
+        parts.year = value / 10000;
+        parts.month = value / 100 % 100;
+        parts.day = value % 100;
+        return DateTimeParser::toDayNumber(parts);
+    };
+
+    events.reserve(rows, header.stringBytes);
+    for (size_t i = 0; i < rows; ++i) {
+        try {
+            events.append(text(name[i]), pool(organizer[i]), Event::parseCategory(text(category[i])),
+                          dayNumber(date[i]), start[i], end[i], seats[i], pool(venue[i]));
+        } catch (const invalid_argument& e) {
+            cerr << "Error parsing event data: " << path << ": row " << i + 1 << ": " << e.what() << endl;
+            if (skipped != nullptr) ++*skipped;
+        }
+    }
+    return events;
+}
+
+void EventBinaryFile::save(const EventTable& events, const string& path) {
+    vector<int32_t> date, seats;
+    vector<uint16_t> start, end;
+    vector<uint32_t> venue, name, organizer, category, offsets{0};
+    string strings;
+    unordered_map<string, uint32_t> ids;
+
+    auto intern = [&](string_view value) {
+        auto it = ids.find(string(value));
+        if (it != ids.end()) return it->second;
+        uint32_t id = offsets.size() - 1;
+        ids.emplace(value, id);
+        strings += value;
+        offsets.push_back(strings.size());
+        return id;
+    };
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events.isErased(i)) continue;
+        DateParts parts = DateTimeParser::fromDayNumber(events.day(i));
+        date.push_back(parts.year * 10000 + parts.month * 100 + parts.day);
+        start.push_back(events.startMinute(i));
+        end.push_back(events.endMinute(i));
+        seats.push_back(events.seats(i));
+        venue.push_back(intern(StringPool::lookup(events.venue(i))));
+        name.push_back(intern(events.name(i)));
+        organizer.push_back(intern(StringPool::lookup(events.organizer(i))));
+        category.push_back(intern(Event::categoryName(events.category(i))));
+    }
+
+    Header header{MAGIC, VERSION, uint32_t(date.size()), uint32_t(offsets.size() - 1), strings.size()};
+    string tmpPath = path + ".tmp";
+    ofstream file(tmpPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        throw runtime_error("Unable to open " + tmpPath + " for writing.");
+    }
+    auto column = [&file](const auto& values) {
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(values[0]));
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    column(date);
+    column(start);
+    column(end);
+    column(seats);
+    column(venue);
+    column(name);
+    column(organizer);
+    column(category);
+    column(offsets);
+    file.write(strings.data(), strings.size());
+    Stats::addBytesWritten(file.tellp());
+    file.close();
+    if (!file || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        throw runtime_error("Unable to write " + path + ".");
+    }
+}
+
+// EventSeries definitions
+int EventSeries::lastDay() const { return first.getDay() + (count - 1) * intervalDays; }
+
+Event EventSeries::occurrence(int index) const {
+    return Event(first.getName(), first.getOrganizer(), first.getCategory(), first.getDay() + index * intervalDays,
+                 first.getStartMinute(), first.getEndMinute(), first.getSeats(), first.getVenue());
+}
+
+// EventStore class definitions
+bool EventStore::SourceStamps::operator==(const SourceStamps& other) const {
+    return base == other.base && journal == other.journal && oldJournal == other.oldJournal && series == other.series;
+}
+
+bool EventStore::SourceStamps::operator!=(const SourceStamps& other) const { return !(*this == other); }
+
+EventStore::EventStore(const string& p)
+    : path(p), journalPath(p + ".journal"), seriesPath(p + ".series"), snapshotPath(p + ".snapshot"),
+      binary(EventBinaryFile::matches(p)) {}
+
+EventStore::~EventStore() {
+    joinCompactor();
+    if (journal.is_open()) journal.close();
+    if (!loaded || readOnly || snapshotStamps == expected || stampSources() != expected) return;
+    try {
+        saveSnapshot();
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+// A background compaction rewrites the base file and removes the old journal.
+void EventStore::joinCompactor() {
+    if (compactor.joinable()) compactor.join();
+    if (compacting) {
+        expected.base = FileStamp::of(path);
+        expected.oldJournal = FileStamp::of(journalPath + ".old");
+        compacting = false;
+    }
+}
+
+EventStore::SourceStamps EventStore::stampSources() const {
+    return {FileStamp::of(path), FileStamp::of(journalPath), FileStamp::of(journalPath + ".old"), FileStamp::of(seriesPath)};
+}
+
+void EventStore::load(bool readOnlyLoad) {
+    Stats::Timer timer(Stats::Load);
+    joinCompactor();
+    loaded = true;
+    readOnly = readOnlyLoad;
+    if (loadSnapshot()) {
+        loadSeries(false);
+        expected = stampSources();
+        return;
+    }
+    snapshotStamps = SourceStamps();
+    unreadable = 0;
+    events = binary ? EventBinaryFile::load(path, &unreadable) : Event::loadAll(path, &unreadable);
+    reindex();
+    occupancy.clear();
+    for (size_t i = 0; i < events.size(); ++i) {
+        occupy(events.venue(i), events.day(i), slotMask(events.startMinute(i), events.endMinute(i)));
+    }
+    journalEntries = 0;
+    replayJournal(journalPath + ".old");
+    replayJournal(journalPath);
+    loadSeries();
+    expected = stampSources();
+}
+
+// Snapshot layout: header | day[] start[] end[] seats[] organizer[] venue[]
+// category[] name offset[] name length[] erased[] | name arena | pool offsets
+// [poolCount + 1] | pool bytes | date order[] start order[] | name slots[] |
+// booked days[]. Organizer and venue columns hold indexes into the
+// snapshot's own string pool; the orders are rows of the indexed events, in
+// each index's order. The venue, category and organizer indexes are subsets
+// of date order and are filled from it.
+//
+// The name index and the room occupancy, series occurrences included, are
+// stored as they are in memory and read back in bulk. The ordered indexes
+// are trees, so they are still rebuilt one node at a time, though always by
+// appending at the end.
+bool EventStore::loadSnapshot() {
+    MappedFile file(snapshotPath);
+    string_view data = file.view();
+    SnapshotHeader header;
+    if (data.size() < sizeof(header)) return false;
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.stamps != stampSources()) {
+        return false;
+    }
+    size_t rows = header.rowCount, indexed = header.indexedCount;
+    size_t size = sizeof(header) + rows * (4 * 4 + 4 * 2 + 1 + 8 + 4 + 1) + header.arenaBytes
+                + (header.poolCount + 1) * 8 + header.poolBytes + indexed * 4 * 2
+                + header.nameSlots * sizeof(EventNameIndex::Slot) + header.bookedDays * sizeof(BookedDay);
+    if (indexed > rows || data.size() != size || (header.nameSlots & (header.nameSlots - 1)) != 0) return false;
+
+    const char* cursor = data.data() + sizeof(header);
+    auto column = [&cursor](auto& out, size_t count) {
+        out.resize(count);
+        memcpy(out.data(), cursor, count * sizeof(out[0]));
+        cursor += count * sizeof(out[0]);
+    };
+    EventTable table;
+    column(table.days, rows);
+    column(table.startMinutes, rows);
+    column(table.endMinutes, rows);
+    column(table.seatCounts, rows);
+    column(table.organizers, rows);
+    column(table.venues, rows);
+    column(table.categories, rows);
+    column(table.nameOffsets, rows);
+    column(table.nameLengths, rows);
+    column(table.erasedFlags, rows);
+    table.arena.assign(cursor, header.arenaBytes);
+    cursor += header.arenaBytes;
+    vector<uint64_t> poolOffsets;
+    column(poolOffsets, header.poolCount + 1);
+    vector<uint32_t> pooled(header.poolCount);
+    for (size_t i = 0; i < header.poolCount; ++i) {
+        if (poolOffsets[i] > poolOffsets[i + 1] || poolOffsets[i + 1] > header.poolBytes) return false;
+        pooled[i] = StringPool::intern(string_view(cursor + poolOffsets[i], poolOffsets[i + 1] - poolOffsets[i]));
+    }
+    cursor += header.poolBytes;
+    vector<uint32_t> dateOrder, startOrder;
+    column(dateOrder, indexed);
+    column(startOrder, indexed);
+    vector<EventNameIndex::Slot> nameSlots;
+    column(nameSlots, header.nameSlots);
+    vector<BookedDay> booked;
+    column(booked, header.bookedDays);
+
+    size_t nameBytes = 0;
+    for (size_t i = 0; i < rows; ++i) {
+        if (table.organizers[i] >= header.poolCount || table.venues[i] >= header.poolCount
+            || uint8_t(table.categories[i]) >= Event::CATEGORY_COUNT || table.erasedFlags[i] > 1
+            || table.nameOffsets[i] + table.nameLengths[i] > header.arenaBytes) {
+            return false;
+        }
+        table.organizers[i] = pooled[table.organizers[i]];
+        table.venues[i] = pooled[table.venues[i]];
+        table.erasedRows += table.erasedFlags[i];
+        nameBytes += table.nameLengths[i];
+    }
+    table.garbage = header.arenaBytes - min<size_t>(nameBytes, header.arenaBytes);
+    for (const auto* order : {&dateOrder, &startOrder}) {
+        for (uint32_t row : *order) {
+            if (row >= rows || table.erasedFlags[row]) return false;
+        }
+    }
+    size_t named = 0, usedSlots = 0;
+    for (const auto& slot : nameSlots) {
+        if (slot.row == EventNameIndex::EMPTY) continue;
+        ++usedSlots;
+        if (slot.row == EventNameIndex::REMOVED) continue;
+        if (slot.row >= rows || table.erasedFlags[slot.row]) return false;
+        ++named;
+    }
+    for (const auto& day : booked) {
+        if (day.venue >= header.poolCount) return false;
+    }
+
+    // Each index is filled in its own order, so every insert lands at the end.
+    events = move(table);
+    clearIndexes();
+    byName.slots = move(nameSlots);
+    byName.live = named;
+    byName.used = usedSlots;
+    occupancy.clear();
+    for (const auto& day : booked) occupancy[pooled[day.venue]].emplace(day.day, day.slots);
+    // One index at a time: each pass appends to few trees, so the nodes it
+    // touches stay in cache. This is about twice as fast as a single pass.
+    auto fill = [&](const function<DayIndex&(uint32_t row)>& indexOf) {
+        for (uint32_t row : dateOrder) {
+            DayIndex& index = indexOf(row);
+            index.emplace_hint(index.end(), events.day(row), events.startMinute(row), row);
+        }
+    };
+    fill([&](uint32_t) -> DayIndex& { return byDate; });
+    fill([&](uint32_t row) -> DayIndex& { return byCategory[int(events.category(row))]; });
+    fill([&](uint32_t row) -> DayIndex& { return byOrganizer[events.organizer(row)]; });
+    fill([&](uint32_t row) -> DayIndex& { return byVenue[events.venue(row)]; });
+    for (uint32_t row : startOrder) byStart.emplace_hint(byStart.end(), events.startMinute(row), events.day(row), row);
+    journalEntries = header.journalEntries;
+    unreadable = header.unreadableLines;
+    snapshotStamps = header.stamps;
+    return true;
+}
+
+void EventStore::saveSnapshot() {
+    size_t rows = events.size();
+    vector<uint32_t> organizers(rows), venues(rows), poolIds;
+    unordered_map<uint32_t, uint32_t> local;
+    auto localId = [&](uint32_t id) {
+        auto it = local.emplace(id, uint32_t(poolIds.size())).first;
+        if (it->second == poolIds.size()) poolIds.push_back(id);
+        return it->second;
+    };
+    for (size_t i = 0; i < rows; ++i) {
+        organizers[i] = localId(events.organizer(i));
+        venues[i] = localId(events.venue(i));
+    }
+    vector<BookedDay> booked;
+    for (const auto& [venue, days] : occupancy) {
+        for (const auto& [day, slots] : days) booked.push_back({localId(venue), day, slots});
+    }
+    vector<uint64_t> poolOffsets{0};
+    string pool;
+    for (uint32_t id : poolIds) {
+        pool += StringPool::lookup(id);
+        poolOffsets.push_back(pool.size());
+    }
+    auto rowsOf = [](const auto& index) {
+        vector<uint32_t> order;
+        order.reserve(index.size());
+        for (const auto& key : index) order.push_back(get<2>(key));
+        return order;
+    };
+    vector<uint32_t> dateOrder = rowsOf(byDate), startOrder = rowsOf(byStart);
+
+    SnapshotHeader header{SNAPSHOT_MAGIC, SNAPSHOT_VERSION, rows, dateOrder.size(), events.arena.size(),
+                          poolIds.size(), pool.size(), byName.slots.size(), booked.size(), journalEntries, unreadable,
+                          expected};
+    string tmpPath = snapshotPath + ".tmp";
+    ofstream file(tmpPath, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        throw runtime_error("Unable to open " + tmpPath + " for writing.");
+    }
+    auto column = [&file](const auto& values) {
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(values[0]));
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    column(events.days);
+    column(events.startMinutes);
+    column(events.endMinutes);
+    column(events.seatCounts);
+    column(organizers);
+    column(venues);
+    column(events.categories);
+    column(events.nameOffsets);
+    column(events.nameLengths);
+    column(events.erasedFlags);
+    file.write(events.arena.data(), events.arena.size());
+    column(poolOffsets);
+    file.write(pool.data(), pool.size());
+    column(dateOrder);
+    column(startOrder);
+    column(byName.slots);
+    column(booked);
+    Stats::addBytesWritten(file.tellp());
+    file.close();
+    if (!file || rename(tmpPath.c_str(), snapshotPath.c_str()) != 0) {
+        throw runtime_error("Unable to write " + snapshotPath + ".");
+    }
+    snapshotStamps = expected;
+}
+
+// Journal lines are tab-separated with backslash escapes, so any event name
+// round-trips: "A <record>", "U <old name> <record>" or "D <name>".
+string EventStore::escapeField(const string& field) {
+    string escaped;
+    escaped.reserve(field.size());
+    for (char c : field) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+vector<string> EventStore::splitJournalLine(string_view line) {
+    vector<string> fields(1);
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\t') {
+            fields.emplace_back();
+        } else if (c == '\\' && i + 1 < line.size()) {
+            char next = line[++i];
+            fields.back() += next == 't' ? '\t' : next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+        } else {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+string EventStore::journalRecord(const Event& event) {
+    return escapeField(event.getName()) + '\t' + escapeField(event.getOrganizer()) + '\t'
+         + escapeField(event.getCategory()) + '\t' + escapeField(event.getDate()) + '\t'
+         + escapeField(event.getStartTime()) + '\t' + escapeField(event.getEndTime()) + '\t'
+         + to_string(event.getSeats()) + '\t' + escapeField(event.getVenue());
+}
+
+void EventStore::replayJournal(const string& file) {
+    MappedFile mapped(file);
+    FieldScanner scanner(mapped.view());
+    while (scanner.nextLine()) {
+        if (scanner.line().empty()) continue;
+        vector<string> f = splitJournalLine(scanner.line());
+        const string& op = f[0];
+        size_t recordAt = op == "A" ? 1 : 2;
+        int seats = 0;
+        bool valid = (op == "D" && f.size() == 2)
+                  || ((op == "A" || op == "U") && f.size() == recordAt + 8 && FieldScanner::toInt(f[recordAt + 6], seats));
+        if (!valid) {
+            // A torn final line after a crash lands here and is skipped.
+            cerr << "Error parsing journal: " << file << ":" << scanner.lineNumber() << ": malformed entry" << endl;
+            continue;
+        }
+        if (op == "D") {
+            erase(f[1]);
+        } else {
+            const string* r = &f[recordAt];
+            try {
+                Event event(r[0], r[1], r[2], r[3], r[4], r[5], seats, r[7]);
+                if (op == "A" || !replace(f[1], event)) upsert(event);
+            } catch (const invalid_argument& e) {
+                cerr << "Error parsing journal: " << file << ":" << scanner.lineNumber() << ": " << e.what() << endl;
+                ++unreadable;  // a whole record with a bad value, unlike a torn line
+                continue;
+            }
+        }
+        ++journalEntries;
+    }
+}
+
+void EventStore::appendJournal(const string& entry) {
+    if (!journal.is_open()) {
+        journal.open(journalPath, ios::app);
+    }
+    journal << entry << '\n';
+    Stats::addBytesWritten(entry.size() + 1);
+    ++journalEntries;
+    if (!batching) {
+        journal.flush();
+        expected.journal = FileStamp::of(journalPath);
+        if (journalEntries > max(COMPACT_THRESHOLD, events.liveRows() / 4)) {
+            compact(true);
+        }
+    }
+}
+
+void EventStore::beginBatch() {
+    batching = true;
+}
+
+void EventStore::endBatch() {
+    batching = false;
+    if (journal.is_open()) {
+        journal.flush();
+        expected.journal = FileStamp::of(journalPath);
+    }
+    if (journalEntries > max(COMPACT_THRESHOLD, events.liveRows() / 4)) {
+        compact(true);
+    }
+}
+
+void EventStore::writeBase(const EventTable& snapshot, const string& path, bool binary) {
+    try {
+        if (binary) {
+            EventBinaryFile::save(snapshot, path);  // writes a temporary file and renames it
+            return;
+        }
+        string tmpPath = path + ".tmp";
+        Event::saveAll(snapshot, tmpPath);
+        if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+            throw runtime_error("Unable to write " + path + ".");
+        }
+    } catch (const runtime_error& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+// Folds the journal into the base file. Only one compaction runs at a time;
+// a background compaction works from a copy of the events so edits can keep
+// appending to the fresh journal meanwhile. It is skipped while any line
+// could not be read, so those lines stay on disk until they are fixed.
+void EventStore::compact(bool background) {
+    if (unreadable > 0) {
+        if (!compactionRefused) {
+            cerr << path << ": " << unreadable << " line(s) could not be read; not compacting until they are fixed." << endl;
+        }
+        compactionRefused = true;
+        return;
+    }
+    joinCompactor();
+    if (journal.is_open()) journal.close();
+
+    string oldJournal = journalPath + ".old";
+    bool pending = !MappedFile(oldJournal).view().empty();
+    if (!pending) {
+        // A previous compaction finished, or none is outstanding.
+        if (rename(journalPath.c_str(), oldJournal.c_str()) != 0 && journalEntries == 0) return;
+    } else {
+        // A crash interrupted a compaction: fold the current journal into the
+        // pending one so both are covered by this snapshot.
+        ofstream out(oldJournal, ios::app);
+        MappedFile current(journalPath);
+        out << current.view();
+        out.close();
+        Stats::addBytesWritten(current.view().size());
+        std::remove(journalPath.c_str());
+    }
+    journalEntries = 0;
+    expected.journal = FileStamp::of(journalPath);
+
+    auto work = [snapshot = events, base = path, old = oldJournal, isBinary = binary]() {
+        writeBase(snapshot, base, isBinary);
+        std::remove(old.c_str());
+    };
+    compacting = true;
+    if (background) {
+        compactor = thread(work);
+    } else {
+        work();
+        joinCompactor();
+    }
+}
+
+void EventStore::clearIndexes() {
+    byName.clear();
+    byDate.clear();
+    byStart.clear();
+    byVenue.clear();
+    for (auto& index : byCategory) index.clear();
+    byOrganizer.clear();
+}
+
+// A duplicate name is listed once: the first occurrence wins, as with a
+// linear scan.
+void EventStore::reindex() {
+    clearIndexes();
+    byName.reserve(events.liveRows());
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events.isErased(i) || byName.find(events.name(i)) != EventNameIndex::npos) continue;
+        byName.insert(i);
+        indexOrder(i);
+    }
+}
+
+// The slot range is widened outwards so a booking that is not on a
+// 15-minute boundary still blocks every slot it touches.
+uint32_t EventStore::slotMask(int startMinute, int endMinute) {
+    if (endMinute <= startMinute) return 0;
+
+    int first = (startMinute - DAY_START_MINUTE) / SLOT_MINUTES;
+    int last = (endMinute - DAY_START_MINUTE + SLOT_MINUTES - 1) / SLOT_MINUTES;
+    first = max(first, 0);
+    last = min(last, SLOT_COUNT);
+    if (first >= last) return 0;
+
+    int width = last - first;
+    uint32_t bits = width == SLOT_COUNT ? 0xFFFFFFFFu : ((1u << width) - 1);
+    return bits << first;
+}
+
+void EventStore::occupy(const Event& event) {
+    occupy(event.getVenueId(), event.getDay(), slotMask(event.getStartMinute(), event.getEndMinute()));
+}
+
+void EventStore::release(const Event& event) {
+    release(event.getVenueId(), event.getDay(), slotMask(event.getStartMinute(), event.getEndMinute()));
+}
+
+void EventStore::occupy(uint32_t venue, int dayNumber, uint32_t mask) {
+    if (mask == 0) return;
+    SlotDay& day = occupancy[venue][dayNumber];
+    day.mask |= mask;
+    for (int slot = 0; slot < SLOT_COUNT; ++slot) {
+        if (mask & (1u << slot)) day.depth[slot]++;
+    }
+}
+
+void EventStore::release(uint32_t venueId, int dayNumber, uint32_t mask) {
+    auto venue = occupancy.find(venueId);
+    if (mask == 0 || venue == occupancy.end()) return;
+    auto it = venue->second.find(dayNumber);
+    if (it == venue->second.end()) return;
+    SlotDay& day = it->second;
+    for (int slot = 0; slot < SLOT_COUNT; ++slot) {
+        if ((mask & (1u << slot)) && day.depth[slot] > 0 && --day.depth[slot] == 0) {
+            day.mask &= ~(1u << slot);
+        }
+    }
+    if (day.mask == 0) venue->second.erase(it);
+}
+
+// `ignore` lets an event being modified look past its own booking.
+bool EventStore::isSlotFree(const string& venue, int day, uint32_t mask, const Event* ignore) const {
+    uint32_t id;
+    if (!StringPool::find(venue, id)) return true;
+    auto days = occupancy.find(id);
+    if (days == occupancy.end()) return true;
+    auto it = days->second.find(day);
+    if (it == days->second.end()) return true;
+    uint32_t busy = it->second.mask;
+    if (ignore != nullptr && ignore->getVenueId() == id && ignore->getDay() == day) {
+        uint32_t own = slotMask(ignore->getStartMinute(), ignore->getEndMinute());
+        for (int slot = 0; slot < SLOT_COUNT; ++slot) {
+            if ((own & (1u << slot)) && it->second.depth[slot] == 1) busy &= ~(1u << slot);
+        }
+    }
+    return (busy & mask) == 0;
+}
+
+const EventTable& EventStore::table() const { return events; }
+
+void EventStore::indexOrder(size_t row) {
+    tuple<int, int, uint32_t> key{events.day(row), events.startMinute(row), uint32_t(row)};
+    byDate.insert(key);
+    byStart.emplace(events.startMinute(row), events.day(row), uint32_t(row));
+    byVenue[events.venue(row)].insert(key);
+    byCategory[int(events.category(row))].insert(key);
+    byOrganizer[events.organizer(row)].insert(key);
+}
+
+void EventStore::unindexOrder(size_t row) {
+    tuple<int, int, uint32_t> key{events.day(row), events.startMinute(row), uint32_t(row)};
+    byDate.erase(key);
+    byStart.erase({events.startMinute(row), events.day(row), uint32_t(row)});
+    byCategory[int(events.category(row))].erase(key);
+    auto dropFrom = [&key](unordered_map<uint32_t, DayIndex>& index, uint32_t id) {
+        auto it = index.find(id);
+        if (it == index.end()) return;
+        it->second.erase(key);
+        if (it->second.empty()) index.erase(it);
+    };
+    dropFrom(byVenue, events.venue(row));
+    dropFrom(byOrganizer, events.organizer(row));
+}
+
+bool EventStore::Query::everything() const {
+    return field == Any && firstDay == INT_MIN && lastDay == INT_MAX;
+}
+
+void EventStore::select(const Query& query, const function<bool(size_t row)>& visit) const {
+    auto walkDays = [&](const DayIndex& index) {
+        for (auto it = index.lower_bound({query.firstDay, INT_MIN, 0}); it != index.end() && get<0>(*it) <= query.lastDay;
+             ++it) {
+            if (!visit(get<2>(*it))) return;
+        }
+    };
+    auto walkId = [&](const unordered_map<uint32_t, DayIndex>& index) {
+        uint32_t id;
+        if (!StringPool::find(query.value, id)) return;
+        auto it = index.find(id);
+        if (it != index.end()) walkDays(it->second);
+    };
+
+    switch (query.field) {
+        case Query::Any: walkDays(byDate); break;
+        case Query::Category:
+            if (Event::isCategory(query.value)) walkDays(byCategory[int(Event::parseCategory(query.value))]);
+            break;
+        case Query::Organizer: walkId(byOrganizer); break;
+        case Query::Venue: walkId(byVenue); break;
+    }
+}
+
+void EventStore::forEach(Order order, const function<bool(size_t row)>& visit) const {
+    auto walk = [&](const auto& index) {
+        for (const auto& key : index) {
+            if (!visit(get<2>(key))) return false;
+        }
+        return true;
+    };
+    switch (order) {
+        case Order::Stored:
+            for (size_t i = 0; i < events.size(); ++i) {
+                if (!events.isErased(i) && !visit(i)) return;
+            }
+            break;
+        case Order::Date: walk(byDate); break;
+        case Order::Start: walk(byStart); break;
+        case Order::Venue: {
+            vector<uint32_t> venues;
+            venues.reserve(byVenue.size());
+            for (const auto& entry : byVenue) venues.push_back(entry.first);
+            sort(venues.begin(), venues.end(),
+                 [](uint32_t a, uint32_t b) { return StringPool::lookup(a) < StringPool::lookup(b); });
+            for (uint32_t venue : venues) {
+                if (!walk(byVenue.at(venue))) return;
+            }
+            break;
+        }
+    }
+}
+
+// Series file lines: the eight event fields, then the interval in days and
+// the number of occurrences.
+void EventStore::loadSeries(bool book) {
+    series.clear();
+    seriesByName.clear();
+    MappedFile file(seriesPath);
+    FieldScanner scanner(file.view());
+    string_view f[10];
+    while (scanner.nextLine()) {
+        if (scanner.line().empty()) continue;
+        int seats, interval, count;
+        if (!scanner.split(f, 10) || !FieldScanner::toInt(f[6], seats) || !FieldScanner::toInt(f[8], interval)
+            || !FieldScanner::toInt(f[9], count) || interval <= 0 || count <= 0) {
+            cerr << "Error parsing series data: " << seriesPath << ":" << scanner.lineNumber() << ": malformed entry" << endl;
+            continue;
+        }
+        try {
+            Event first{string(f[0]), string(f[1]), string(f[2]), string(f[3]), string(f[4]), string(f[5]), seats, string(f[7])};
+            EventSeries entry{first, interval, count};
+            seriesByName.emplace(first.getName(), series.size());
+            series.push_back(entry);
+            for (int i = 0; book && i < count; ++i) occupy(entry.occurrence(i));
+        } catch (const invalid_argument& e) {
+            cerr << "Error parsing series data: " << seriesPath << ":" << scanner.lineNumber() << ": " << e.what() << endl;
+        }
+    }
+}
+
+void EventStore::saveSeries(const string& target) const {
+    string tmpPath = target + ".tmp";
+    ofstream file(tmpPath, ios::trunc);
+    if (!file.is_open()) {
+        throw runtime_error("Unable to open " + tmpPath + " for writing.");
+    }
+    for (const auto& entry : series) {
+        const Event& e = entry.first;
+        file << e.getName() << "," << e.getOrganizer() << "," << e.getCategory() << "," << e.getDate() << ","
+             << e.getStartTime() << "," << e.getEndTime() << "," << e.getSeats() << "," << e.getVenue() << ","
+             << entry.intervalDays << "," << entry.count << "\n";
+    }
+    Stats::addBytesWritten(file.tellp());
+    file.close();
+    if (!file || rename(tmpPath.c_str(), target.c_str()) != 0) {
+        throw runtime_error("Unable to write " + target + ".");
+    }
+}
+
+void EventStore::exportTo(const string& target) const {
+    if (EventBinaryFile::matches(target)) {
+        EventBinaryFile::save(events, target);
+    } else {
+        Event::saveAll(events, target);
+    }
+    string targetSeries = target + ".series";
+    if (series.empty()) {
+        std::remove(targetSeries.c_str());
+    } else {
+        saveSeries(targetSeries);
+    }
+}
+
+const vector<EventSeries>& EventStore::allSeries() const { return series; }
+
+const EventSeries* EventStore::findSeries(const string& name) const {
+    auto it = seriesByName.find(name);
+    return it == seriesByName.end() ? nullptr : &series[it->second];
+}
+
+void EventStore::addSeries(const EventSeries& entry) {
+    seriesByName.emplace(entry.first.getName(), series.size());
+    series.push_back(entry);
+    for (int i = 0; i < entry.count; ++i) occupy(entry.occurrence(i));
+    saveSeries(seriesPath);
+    expected.series = FileStamp::of(seriesPath);
+}
+
+bool EventStore::removeSeries(const string& name) {
+    auto it = seriesByName.find(name);
+    if (it == seriesByName.end()) return false;
+    const EventSeries& entry = series[it->second];
+    for (int i = 0; i < entry.count; ++i) release(entry.occurrence(i));
+    series.erase(series.begin() + it->second);
+    seriesByName.clear();
+    for (size_t i = 0; i < series.size(); ++i) seriesByName.emplace(series[i].first.getName(), i);
+    saveSeries(seriesPath);
+    expected.series = FileStamp::of(seriesPath);
+    return true;
+}
+
+vector<EventStore::FreeSlot> EventStore::earliestFree(const vector<string>& venues, int firstDay, int lastDay,
+                                                      int slotCount, size_t limit) const {
+    vector<FreeSlot> found;
+    if (slotCount <= 0 || slotCount > SLOT_COUNT || limit == 0) return found;
+
+    vector<const VenueDays*> booked;
+    for (const auto& venue : venues) {
+        uint32_t id;
+        auto it = StringPool::find(venue, id) ? occupancy.find(id) : occupancy.end();
+        booked.push_back(it == occupancy.end() ? nullptr : &it->second);
+    }
+    // Bit i of a run mask is set when slots i .. i + slotCount - 1 are free.
+    uint32_t startable = slotCount == SLOT_COUNT ? 1u : (1u << (SLOT_COUNT - slotCount + 1)) - 1;
+    vector<uint32_t> runs(venues.size());
+    for (int day = firstDay; day <= lastDay; ++day) {
+        uint32_t any = 0;
+        for (size_t v = 0; v < venues.size(); ++v) {
+            uint32_t busy = 0;
+            if (booked[v] != nullptr) {
+                auto it = booked[v]->find(day);
+                if (it != booked[v]->end()) busy = it->second.mask;
+            }
+            uint32_t run = ~busy;
+            for (int k = 1; k < slotCount; ++k) run &= ~busy >> k;
+            runs[v] = run & startable;
+            any |= runs[v];
+        }
+        while (any != 0) {
+            int slot = __builtin_ctz(any);
+            any &= any - 1;
+            for (size_t v = 0; v < venues.size(); ++v) {
+                if (runs[v] & (1u << slot)) {
+                    found.push_back({day, DAY_START_MINUTE + slot * SLOT_MINUTES, venues[v]});
+                    break;
+                }
+            }
+            if (found.size() == limit) return found;
+        }
+    }
+    return found;
+}
+
+// Whichever is smaller is walked once: the series' days, looked up in the
+// venue's occupancy, or the venue's booked days, tested for membership of
+// the series.
+bool EventStore::isSeriesFree(const string& venue, int firstDay, int intervalDays, int count, uint32_t mask) const {
+    uint32_t id;
+    if (!StringPool::find(venue, id)) return true;
+    auto days = occupancy.find(id);
+    if (days == occupancy.end()) return true;
+    const VenueDays& booked = days->second;
+    if (booked.size() < size_t(count)) {
+        int lastDay = firstDay + (count - 1) * intervalDays;
+        for (const auto& entry : booked) {
+            int day = entry.first;
+            if (day >= firstDay && day <= lastDay && (day - firstDay) % intervalDays == 0 && (entry.second.mask & mask)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    for (int i = 0; i < count; ++i) {
+        auto it = booked.find(firstDay + i * intervalDays);
+        if (it != booked.end() && (it->second.mask & mask)) return false;
+    }
+    return true;
+}
+
+void EventStore::forEachOccurrence(const Query& query, const function<bool(const Event&)>& visit) const {
+    // Resolve the filter once; an unknown value matches nothing.
+    uint32_t id = 0;
+    if (query.field == Query::Category) {
+        if (!Event::isCategory(query.value)) return;
+        id = uint32_t(Event::parseCategory(query.value));
+    } else if (query.field != Query::Any && !StringPool::find(query.value, id)) {
+        return;
+    }
+    for (const auto& entry : series) {
+        const Event& e = entry.first;
+        if ((query.field == Query::Category && uint32_t(e.getCategoryId()) != id)
+            || (query.field == Query::Organizer && e.getOrganizerId() != id)
+            || (query.field == Query::Venue && e.getVenueId() != id)) {
+            continue;
+        }
+        long long from = max<long long>(query.firstDay, e.getDay());
+        long long to = min<long long>(query.lastDay, entry.lastDay());
+        if (from > to) continue;
+        int firstIndex = int((from - e.getDay() + entry.intervalDays - 1) / entry.intervalDays);
+        for (int i = firstIndex; i < entry.count && e.getDay() + i * entry.intervalDays <= to; ++i) {
+            if (!visit(entry.occurrence(i))) return;
+        }
+    }
+}
+
+optional<Event> EventStore::find(const string& name) const {
+    size_t row = byName.find(name);
+    if (row == EventNameIndex::npos) return nullopt;
+    return events.row(row);
+}
+
+size_t EventStore::position(const string& name) const { return byName.find(name); }
+
+bool EventStore::contains(const string& name) const { return byName.find(name) != EventNameIndex::npos; }
+
+void EventStore::upsert(const Event& event) {
+    if (replace(event.getName(), event)) return;
+    events.append(event);
+    byName.insert(events.size() - 1);
+    occupy(event);
+    indexOrder(events.size() - 1);
+}
+
+// The event keeps its row, and so its place in stored order, even when it is
+// renamed. Callers check that a new name is free; a journal written before
+// that check existed may still rename onto another event, which is dropped.
+bool EventStore::replace(const string& name, const Event& event) {
+    if (event.getName() != name && contains(name)) erase(event.getName());
+    size_t row = byName.find(name);
+    if (row == EventNameIndex::npos) return false;
+    release(events.venue(row), events.day(row), slotMask(events.startMinute(row), events.endMinute(row)));
+    unindexOrder(row);
+    bool renamed = event.getName() != name;
+    if (renamed) byName.erase(row);
+    events.assign(row, event);
+    if (renamed) byName.insert(row);
+    occupy(event);
+    indexOrder(row);
+    return true;
+}
+
+// The row is only marked erased. Once erased rows outnumber live ones they
+// are dropped in one pass and the row numbers rebuilt, so deletes cost
+// amortized O(1) row moves.
+bool EventStore::erase(const string& name) {
+    size_t row = byName.find(name);
+    if (row == EventNameIndex::npos) return false;
+    release(events.venue(row), events.day(row), slotMask(events.startMinute(row), events.endMinute(row)));
+    unindexOrder(row);
+    byName.erase(row);
+    events.erase(row);
+    if (events.size() - events.liveRows() > max(COMPACT_THRESHOLD, events.liveRows())) {
+        events.dropErased();
+        reindex();
+    }
+    return true;
+}
+
+void EventStore::add(const Event& event) {
+    Stats::Timer timer(Stats::Add);
+    upsert(event);
+    appendJournal("A\t" + journalRecord(event));
+}
+
+bool EventStore::remove(const string& name) {
+    Stats::Timer timer(Stats::Delete);
+    if (!erase(name)) return false;
+    appendJournal("D\t" + escapeField(name));
+    return true;
+}
+
+bool EventStore::update(const string& name, const Event& event) {
+    Stats::Timer timer(Stats::Modify);
+    if (!contains(name)) return false;
+    if (event.getName() != name && (contains(event.getName()) || findSeries(event.getName()) != nullptr)) {
+        throw invalid_argument("An event with this name already exists.");
+    }
+    replace(name, event);
+    appendJournal("U\t" + escapeField(name) + '\t' + journalRecord(event));
+    return true;
+}
+
+// VenueCatalogue class definitions
+bool VenueCatalogue::Venue::hasAttribute(const string& attribute) const {
+    return std::find(attributes.begin(), attributes.end(), attribute) != attributes.end();
+}
+
+VenueCatalogue::VenueCatalogue() {
+    add({"Room 1", 35, {}});
+    add({"Room 2", 35, {}});
+    add({"ITB lab 1", 20, {"lab"}});
+    add({"ITB lab 2", 20, {"lab"}});
+    add({"Project lab", 40, {"lab"}});
+    add({"Programming lab", 40, {"lab"}});
+    add({"IT Conference room", 65, {"projector"}});
+    add({"CS Lab 3", 130, {"lab", "projector"}});
+    add({"Smart Conference Room", 210, {"projector"}});
+    add({"Auditorium", 500, {"projector"}});
+    sortByCapacity();
+}
+
+VenueCatalogue VenueCatalogue::load(const string& path) {
+    MappedFile file(path);
+    if (file.view().empty()) return VenueCatalogue();
+
+    VenueCatalogue catalogue;
+    catalogue.venues.clear();
+    catalogue.byName.clear();
+    FieldScanner scanner(file.view());
+    string_view f[3];
+    while (scanner.nextLine()) {
+        string_view line = scanner.line();
+        if (line.empty() || line[0] == '#') continue;
+        bool hasAttributes = scanner.split(f, 3);
+        if (!hasAttributes && !scanner.split(f, 2)) {
+            cerr << "Error parsing venue data: " << path << ":" << scanner.lineNumber() << ": expected name,capacity" << endl;
+            continue;
+        }
+        Venue venue;
+        venue.name = string(f[0]);
+        if (!FieldScanner::toInt(f[1], venue.capacity) || venue.capacity <= 0) {
+            cerr << "Error parsing venue data: " << path << ":" << scanner.lineNumber() << ": invalid capacity \"" << f[1] << "\"" << endl;
+            continue;
+        }
+        if (hasAttributes) {
+            string_view rest = f[2];
+            while (!rest.empty()) {
+                size_t end = min(rest.find(';'), rest.size());
+                if (end > 0) venue.attributes.emplace_back(rest.substr(0, end));
+                rest.remove_prefix(min(end + 1, rest.size()));
+            }
+        }
+        if (!catalogue.add(move(venue))) {
+            cerr << "Error parsing venue data: " << path << ":" << scanner.lineNumber() << ": duplicate venue \"" << f[0] << "\"" << endl;
+        }
+    }
+    if (catalogue.venues.empty()) {
+        cerr << "No venues in " << path << "; using the built-in rooms." << endl;
+        return VenueCatalogue();
+    }
+    catalogue.sortByCapacity();
+    return catalogue;
+}
+
+bool VenueCatalogue::add(Venue venue) {
+    if (!byName.emplace(venue.name, venues.size()).second) return false;
+    venues.push_back(move(venue));
+    return true;
+}
+
+void VenueCatalogue::sortByCapacity() {
+    sort(venues.begin(), venues.end(), [](const Venue& a, const Venue& b) {
+        return a.capacity != b.capacity ? a.capacity < b.capacity : a.name < b.name;
+    });
+    byName.clear();
+    for (size_t i = 0; i < venues.size(); ++i) byName.emplace(venues[i].name, i);
+}
+
+const vector<VenueCatalogue::Venue>& VenueCatalogue::all() const { return venues; }
+
+vector<VenueCatalogue::Venue>::const_iterator VenueCatalogue::firstFitting(int seats) const {
+    return lower_bound(venues.begin(), venues.end(), seats,
+                       [](const Venue& venue, int wanted) { return venue.capacity < wanted; });
+}
+
+const VenueCatalogue::Venue* VenueCatalogue::find(const string& name) const {
+    auto it = byName.find(name);
+    return it == byName.end() ? nullptr : &venues[it->second];
+}
+
+// VenueOptimizer class definitions
+VenueOptimizer::VenueOptimizer(const EventStore& s, vector<Room> r, chrono::milliseconds budget)
+    : store(s), rooms(move(r)), deadline(chrono::steady_clock::now() + budget) {
+    stable_sort(rooms.begin(), rooms.end(), [](const Room& a, const Room& b) { return a.capacity < b.capacity; });
+}
+
+const VenueOptimizer::Room& VenueOptimizer::room(int index) const { return rooms[index]; }
+
+bool VenueOptimizer::expired() const { return chrono::steady_clock::now() >= deadline; }
+
+string VenueOptimizer::key(int request, int room) const {
+    return to_string((*requests)[request].day) + '\n' + rooms[room].name;
+}
+
+bool VenueOptimizer::fits(int request, int room) const {
+    const Request& r = (*requests)[request];
+    if (rooms[room].capacity < r.seats || !store.isSlotFree(rooms[room].name, r.day, r.mask)) return false;
+    auto it = placed.find(key(request, room));
+    if (it == placed.end()) return true;
+    for (int other : it->second) {
+        if (other != request && ((*requests)[other].mask & r.mask)) return false;
+    }
+    return true;
+}
+
+// Rooms are sorted by capacity, so the first room that fits wastes the fewest seats.
+int VenueOptimizer::bestFit(int request) const {
+    int seats = (*requests)[request].seats;
+    auto first = lower_bound(rooms.begin(), rooms.end(), seats,
+                             [](const Room& room, int wanted) { return room.capacity < wanted; });
+    for (size_t room = first - rooms.begin(); room < rooms.size(); ++room) {
+        if (fits(request, room)) return room;
+    }
+    return -1;
+}
+
+void VenueOptimizer::assign(int request, int room) {
+    assigned[request] = room;
+    placed[key(request, room)].push_back(request);
+}
+
+void VenueOptimizer::unassign(int request) {
+    vector<int>& members = placed[key(request, assigned[request])];
+    members.erase(find(members.begin(), members.end(), request));
+    assigned[request] = -1;
+}
+
+// Tries each large-enough room in turn: books `request` there and re-places
+// the group members it overlaps elsewhere, undoing the move if any of them
+// no longer fits anywhere.
+bool VenueOptimizer::makeRoomFor(int request) {
+    const Request& r = (*requests)[request];
+    for (size_t room = 0; room < rooms.size() && !expired(); ++room) {
+        if (rooms[room].capacity < r.seats || !store.isSlotFree(rooms[room].name, r.day, r.mask)) continue;
+
+        vector<int> blockers;
+        for (int other : placed[key(request, room)]) {
+            if ((*requests)[other].mask & r.mask) blockers.push_back(other);
+        }
+        for (int blocker : blockers) unassign(blocker);
+        assign(request, room);
+
+        vector<int> moved;
+        for (int blocker : blockers) {
+            int target = bestFit(blocker);
+            if (target < 0) break;
+            assign(blocker, target);
+            moved.push_back(blocker);
+        }
+        if (moved.size() == blockers.size()) return true;
+
+        for (int blocker : moved) unassign(blocker);
+        unassign(request);
+        for (int blocker : blockers) assign(blocker, room);
+    }
+    return false;
+}
+
+vector<int> VenueOptimizer::place(const vector<Request>& group) {
+    Stats::Timer timer(Stats::Optimize);
+    requests = &group;
+    assigned.assign(group.size(), -1);
+    placed.clear();
+
+    vector<int> order(group.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&group](int a, int b) {
+        if (group[a].seats != group[b].seats) return group[a].seats > group[b].seats;
+        return __builtin_popcount(group[a].mask) > __builtin_popcount(group[b].mask);
+    });
+
+    for (int request : order) {
+        int room = bestFit(request);
+        if (room >= 0) assign(request, room);
+    }
+
+    // Each accepted move either places one more event or strictly shrinks a
+    // room, so the loop terminates even without the budget.
+    bool improved = true;
+    while (improved && !expired()) {
+        improved = false;
+        for (int request : order) {
+            if (assigned[request] < 0 && makeRoomFor(request)) improved = true;
+            if (expired()) break;
+        }
+        for (int request : order) {
+            if (assigned[request] < 0) continue;
+            int current = assigned[request];
+            unassign(request);
+            int room = bestFit(request);
+            assign(request, room);
+            if (rooms[room].capacity < rooms[current].capacity) improved = true;
+        }
+    }
+
+    requests = nullptr;
+    return assigned;
+}
+
+// Participant class definitions
+Participant::Participant() = default;
+Participant::Participant(string n, string r, string d, string p, string e)
+    : name(n), rollNumber(r), department(d), phoneNumber(p), eventName(e) {}
+
+string Participant::getName() const { return name; }
+string Participant::getRollNumber() const { return rollNumber; }
+string Participant::getDepartment() const { return department; }
+string Participant::getPhoneNumber() const { return phoneNumber; }
+string Participant::getEventName() const { return eventName; }
+
+void Participant::write(ostream& out) const {
+    string record = name + "," + rollNumber + "," + department + "," + phoneNumber + "," + eventName + "\n";
+    out << record;
+    Stats::addBytesWritten(record.size());
+}
+
+void Participant::save(const string& path) const {
+    ofstream file(path, ios::app);
+    if (file.is_open()) {
+        write(file);
+        file.close();
+    } else {
+       // cerr << "Unable to open file to save participant." << endl;
+    }
+}
+
+// Each chunk is counted into its own map, and the maps are summed at the end.
+map<string, int> Participant::countByEvent(const string& path) {
+    Stats::countParticipantsParse();
+    MappedFile file(path);
+    vector<string_view> chunks = ChunkedParser::split(file.view());
+    vector<unordered_map<string_view, int>> partials(chunks.size());
+    vector<vector<size_t>> errors(chunks.size());
+    vector<size_t> lineCounts(chunks.size());
+
+    ChunkedParser::run(chunks, [&](size_t chunk, string_view text) {
+        FieldScanner scanner(text);
+        unordered_map<string_view, int>& counts = partials[chunk];
+        string_view f[5];
+        while (scanner.nextLine()) {
+            if (scanner.line().empty()) continue;
+            // The same split as the other readers, so an event name with a
+            // comma in it is counted under its whole name.
+            if (!scanner.split(f, 5)) {
+                errors[chunk].push_back(scanner.lineNumber());
+                continue;
+            }
+            counts[f[4]]++;
+        }
+        lineCounts[chunk] = scanner.lineNumber();
+    });
+
+    size_t firstLine = 0;
+    for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+        for (size_t line : errors[chunk]) {
+            cerr << "Error parsing participant data: " << path << ":" << firstLine + line << ": expected 5 fields" << endl;
+        }
+        firstLine += lineCounts[chunk];
+    }
+    for (size_t chunk = 1; chunk < partials.size(); ++chunk) {
+        for (const auto& entry : partials[chunk]) partials[0][entry.first] += entry.second;
+    }
+
+    map<string, int> participantCount;
+    if (partials.empty()) return participantCount;
+    for (const auto& entry : partials[0]) {
+        participantCount.emplace(string(entry.first), entry.second);
+    }
+    return participantCount;
+}
+
+// RegistrationKeys class definitions
+void RegistrationKeys::clear() {
+    bloom.clear();
+    counts.clear();
+}
+
+uint64_t RegistrationKeys::hash(string_view eventName, string_view rollNumber) {
+    uint64_t h = std::hash<string_view>()(eventName);
+    return (h ^ (h >> 29)) * 0x9E3779B97F4A7C15ull ^ std::hash<string_view>()(rollNumber);
+}
+
+string RegistrationKeys::key(string_view eventName, string_view rollNumber) {
+    string joined;
+    joined.reserve(eventName.size() + rollNumber.size() + 1);
+    joined.append(eventName).append(1, '\n').append(rollNumber);
+    return joined;
+}
+
+// Double hashing: probe i tests bit h1 + i * h2.
+bool RegistrationKeys::mayContain(uint64_t h) const {
+    if (bloom.empty()) return false;
+    uint64_t mask = bloom.size() * 64 - 1, step = (h >> 32) | 1;
+    for (int i = 0; i < PROBES; ++i, h += step) {
+        if (!(bloom[(h & mask) >> 6] & (1ull << (h & 63)))) return false;
+    }
+    return true;
+}
+
+void RegistrationKeys::mark(uint64_t h) {
+    uint64_t mask = bloom.size() * 64 - 1, step = (h >> 32) | 1;
+    for (int i = 0; i < PROBES; ++i, h += step) bloom[(h & mask) >> 6] |= 1ull << (h & 63);
+}
+
+bool RegistrationKeys::contains(string_view eventName, string_view rollNumber) const {
+    return mayContain(hash(eventName, rollNumber)) && counts.count(key(eventName, rollNumber)) > 0;
+}
+
+void RegistrationKeys::insert(string_view eventName, string_view rollNumber) {
+    ++counts[key(eventName, rollNumber)];
+    if (counts.size() * BITS_PER_KEY > bloom.size() * 64) {
+        size_t words = 16;
+        while (words * 64 < counts.size() * BITS_PER_KEY * 2) words *= 2;
+        bloom.assign(words, 0);
+        for (const auto& entry : counts) {
+            size_t split = entry.first.find('\n');
+            mark(hash(string_view(entry.first).substr(0, split), string_view(entry.first).substr(split + 1)));
+        }
+    } else {
+        mark(hash(eventName, rollNumber));
+    }
+}
+
+void RegistrationKeys::erase(string_view eventName, string_view rollNumber) {
+    auto it = counts.find(key(eventName, rollNumber));
+    if (it != counts.end() && --it->second == 0) counts.erase(it);
+}
+
+// RegistrationIndex class definitions
+RegistrationIndex::RegistrationIndex(const string& p) : path(p), indexPath(p + ".idx"), waitlistPath(p + ".waitlist") {}
+
+RegistrationIndex::~RegistrationIndex() {
+    save();
+}
+
+void RegistrationIndex::load() {
+    if (!loadSidecar()) {
+        rebuild();
+    }
+    loadWaitlist();
+    keysLoaded = false;
+    expectedSize = FileStamp::of(path).size;
+}
+
+// Sidecar layout: "stamp,<size>,<mtime ns>" then one "<count>,<event name>"
+// line per event.
+bool RegistrationIndex::loadSidecar() {
+    MappedFile file(indexPath);
+    FieldScanner scanner(file.view());
+    FileStamp current = FileStamp::of(path);
+    if (!scanner.nextLine()) return false;
+
+    string_view header[3];
+    if (!scanner.split(header, 3) || header[0] != "stamp"
+        || header[1] != to_string(current.size) || header[2] != to_string(current.mtimeNs)) {
+        return false;
+    }
+
+    counts.clear();
+    string_view f[2];
+    int n;
+    while (scanner.nextLine()) {
+        if (!scanner.split(f, 2) || !FieldScanner::toInt(f[0], n)) return false;
+        counts[string(f[1])].taken = n;
+    }
+    return true;
+}
+
+void RegistrationIndex::rebuild() {
+    counts.clear();
+    for (const auto& entry : Participant::countByEvent(path)) {
+        counts[entry.first].taken = entry.second;
+    }
+    dirty = true;
+}
+
+// The waitlist uses the participants file's line format, oldest first.
+void RegistrationIndex::loadWaitlist() {
+    waitlists.clear();
+    MappedFile file(waitlistPath);
+    FieldScanner scanner(file.view());
+    string_view f[5];
+    while (scanner.nextLine()) {
+        if (scanner.line().empty()) continue;
+        if (!scanner.split(f, 5)) {
+            cerr << "Error parsing waitlist: " << waitlistPath << ":" << scanner.lineNumber() << ": expected 5 fields" << endl;
+            continue;
+        }
+        waitlists[string(f[4])].emplace_back(string(f[0]), string(f[1]), string(f[2]), string(f[3]), string(f[4]));
+    }
+}
+
+// Called with fileLock held. One streaming pass over participants.txt, plus
+// the waitlists already in memory. The seat counts are re-read in the same
+// pass, so registrations another process appended are counted as well.
+void RegistrationIndex::loadKeys() {
+    if (batchFile.is_open()) batchFile.flush();
+    Stats::countParticipantsParse();
+    keys.clear();
+    unordered_map<string_view, int> seated;
+    MappedFile file(path);
+    FieldScanner scanner(file.view());
+    string_view f[5];
+    while (scanner.nextLine()) {
+        if (!scanner.split(f, 5)) continue;
+        keys.insert(f[4], f[1]);
+        ++seated[f[4]];
+    }
+    for (const auto& queue : waitlists) {
+        for (const auto& participant : queue.second) keys.insert(queue.first, participant.getRollNumber());
+    }
+    {
+        // Counters are reset rather than erased, so references stay valid.
+        unique_lock<shared_mutex> write(countsLock);
+        for (auto& entry : counts) entry.second.taken = 0;
+        for (const auto& entry : seated) counts[string(entry.first)].taken = entry.second;
+    }
+    keysLoaded = true;
+    stale = false;
+    dirty = true;
+    expectedSize = file.view().size();
+}
+
+void RegistrationIndex::saveWaitlist() {
+    string tmpPath = waitlistPath + ".tmp";
+    ofstream file(tmpPath, ios::trunc);
+    if (!file.is_open()) return;
+    for (const auto& entry : waitlists) {
+        for (const auto& participant : entry.second) participant.write(file);
+    }
+    file.close();
+    if (!file || rename(tmpPath.c_str(), waitlistPath.c_str()) != 0) {
+        cerr << "Unable to write " << waitlistPath << "." << endl;
+    }
+}
+
+// The sidecar is stamped with the file as it is now, so it is only written
+// if nobody else has appended since our last read or write.
+void RegistrationIndex::save() {
+    if (stale) {
+        std::remove(indexPath.c_str());
+        return;
+    }
+    if (!dirty) return;
+
+    FileStamp current = FileStamp::of(path);
+    if (current.size != expectedSize) {
+        std::remove(indexPath.c_str());
+        return;
+    }
+    string tmpPath = indexPath + ".tmp";
+    ofstream file(tmpPath, ios::trunc);
+    if (!file.is_open()) return;
+    file << "stamp," << current.size << "," << current.mtimeNs << "\n";
+    for (const auto& entry : counts) {
+        file << entry.second.taken.load() << "," << entry.first << "\n";
+    }
+    Stats::addBytesWritten(file.tellp());
+    file.close();
+    if (file && rename(tmpPath.c_str(), indexPath.c_str()) == 0) {
+        dirty = false;
+    }
+}
+
+int RegistrationIndex::count(const string& eventName) const {
+    shared_lock<shared_mutex> read(countsLock);
+    auto it = counts.find(eventName);
+    return it == counts.end() ? 0 : it->second.taken.load();
+}
+
+size_t RegistrationIndex::waitlistLength(const string& eventName) {
+    lock_guard<mutex> guard(fileLock);
+    auto it = waitlists.find(eventName);
+    return it == waitlists.end() ? 0 : it->second.size();
+}
+
+RegistrationIndex::SeatCounter& RegistrationIndex::counter(const string& eventName) {
+    {
+        shared_lock<shared_mutex> read(countsLock);
+        auto it = counts.find(eventName);
+        if (it != counts.end()) return it->second;
+    }
+    unique_lock<shared_mutex> write(countsLock);
+    return counts[eventName];
+}
+
+bool RegistrationIndex::tryReserve(SeatCounter& seats, int capacity) {
+    int taken = seats.taken.load();
+    while (taken < capacity) {
+        if (seats.taken.compare_exchange_weak(taken, taken + 1)) return true;
+    }
+    return false;
+}
+
+// Called with fileLock held, after a seat has been reserved.
+void RegistrationIndex::append(const Participant& participant) {
+    if (batchFile.is_open()) {
+        participant.write(batchFile);
+    } else {
+        if (FileStamp::of(path).size != expectedSize) stale = true;  // someone else appended
+        participant.save(path);
+        expectedSize = FileStamp::of(path).size;
+    }
+    dirty = true;
+}
+
+// The seat is reserved under fileLock, after the counts have caught up with
+// any registrations another process appended, so those are never
+// overwritten by a recount while a reservation is in flight.
+RegistrationIndex::Outcome RegistrationIndex::enrol(const Participant& participant, int capacity) {
+    Stats::Timer timer(Stats::Register);
+    lock_guard<mutex> guard(fileLock);
+    if (!batchFile.is_open() && FileStamp::of(path).size != expectedSize) {
+        keysLoaded = false;  // someone else wrote the file; re-read counts and keys
+    }
+    if (!keysLoaded) loadKeys();
+    if (keys.contains(participant.getEventName(), participant.getRollNumber())) {
+        throw invalid_argument("Roll number " + participant.getRollNumber() + " already has a place in \""
+                               + participant.getEventName() + "\".");
+    }
+    keys.insert(participant.getEventName(), participant.getRollNumber());
+    // Never jump an existing queue.
+    SeatCounter& seats = counter(participant.getEventName());
+    deque<Participant>& queue = waitlists[participant.getEventName()];
+    if (!queue.empty() || !tryReserve(seats, capacity)) {
+        queue.push_back(participant);
+        ofstream file(waitlistPath, ios::app);
+        participant.write(file);  // counts the bytes written
+        return {true, queue.size()};
+    }
+    append(participant);
+    return {};
+}
+
+RegistrationIndex::Cancellation RegistrationIndex::cancel(const string& eventName, const string& rollNumber, int capacity) {
+    lock_guard<mutex> guard(fileLock);
+    Cancellation result;
+    auto waiting = waitlists.find(eventName);
+    if (waiting != waitlists.end()) {
+        deque<Participant>& queue = waiting->second;
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->getRollNumber() == rollNumber) {
+                queue.erase(it);
+                saveWaitlist();
+                keys.erase(eventName, rollNumber);
+                result.found = true;
+                return result;
+            }
+        }
+    }
+
+    if (!removeRegistration(eventName, rollNumber)) return result;
+    keys.erase(eventName, rollNumber);
+    result.found = true;
+    counter(eventName).taken.fetch_sub(1);
+    result.promoted = promoteLocked(eventName, capacity);
+    return result;
+}
+
+vector<Participant> RegistrationIndex::promote(const string& eventName, int capacity) {
+    lock_guard<mutex> guard(fileLock);
+    return promoteLocked(eventName, capacity);
+}
+
+vector<Participant> RegistrationIndex::promoteLocked(const string& eventName, int capacity) {
+    vector<Participant> promoted;
+    auto waiting = waitlists.find(eventName);
+    if (waiting == waitlists.end()) return promoted;
+    SeatCounter& seats = counter(eventName);
+    while (!waiting->second.empty() && tryReserve(seats, capacity)) {
+        append(waiting->second.front());
+        promoted.push_back(waiting->second.front());
+        waiting->second.pop_front();
+    }
+    if (!promoted.empty()) saveWaitlist();
+    return promoted;
+}
+
+// Rewrites participants.txt without the event's first registration for the
+// roll number. Cancelling is rare next to registering, so the append-only
+// file is kept and this pays for a full rewrite.
+bool RegistrationIndex::removeRegistration(const string& eventName, const string& rollNumber) {
+    bool batching = batchFile.is_open();
+    if (batching) {
+        batchFile.close();
+    } else if (FileStamp::of(path).size != expectedSize) {
+        stale = true;
+    }
+
+    string kept;
+    bool removed = false;
+    {
+        MappedFile file(path);
+        FieldScanner scanner(file.view());
+        kept.reserve(file.view().size());
+        string_view f[5];
+        while (scanner.nextLine()) {
+            if (!removed && scanner.split(f, 5) && f[1] == rollNumber && f[4] == eventName) {
+                removed = true;
+                continue;
+            }
+            if (!scanner.line().empty()) {
+                kept += scanner.line();
+                kept += '\n';
+            }
+        }
+    }
+    if (removed) rewrite(kept);
+    if (batching) batchFile.open(path, ios::app);
+    return removed;
+}
+
+// Called with fileLock held and no batch file open.
+void RegistrationIndex::rewrite(const string& contents) {
+    string tmpPath = path + ".tmp";
+    ofstream out(tmpPath, ios::trunc);
+    out << contents;
+    out.close();
+    if (!out || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        throw runtime_error("Unable to write " + path + ".");
+    }
+    Stats::addBytesWritten(contents.size());
+    expectedSize = FileStamp::of(path).size;
+    dirty = true;
+}
+
+void RegistrationIndex::renameEvent(const string& from, const string& to) {
+    if (from == to) return;
+    lock_guard<mutex> guard(fileLock);
+    bool batching = batchFile.is_open();
+    if (batching) {
+        batchFile.close();
+    } else if (FileStamp::of(path).size != expectedSize) {
+        stale = true;
+    }
+
+    string moved;
+    bool changed = false;
+    {
+        MappedFile file(path);
+        FieldScanner scanner(file.view());
+        moved.reserve(file.view().size());
+        string_view f[5];
+        while (scanner.nextLine()) {
+            string_view line = scanner.line();
+            if (line.empty()) continue;
+            if (scanner.split(f, 5) && f[4] == from) {
+                moved.append(line.data(), f[4].data() - line.data());  // the event name is the last field
+                moved += to;
+                changed = true;
+            } else {
+                moved += line;
+            }
+            moved += '\n';
+        }
+    }
+    if (changed) rewrite(moved);
+    if (batching) batchFile.open(path, ios::app);
+
+    {
+        unique_lock<shared_mutex> write(countsLock);
+        auto it = counts.find(from);
+        if (it != counts.end()) {
+            counts[to].taken += it->second.taken.exchange(0);
+            dirty = true;
+        }
+    }
+    auto waiting = waitlists.find(from);
+    if (waiting != waitlists.end()) {
+        deque<Participant>& queue = waitlists[to];
+        for (const Participant& p : waiting->second) {
+            queue.emplace_back(p.getName(), p.getRollNumber(), p.getDepartment(), p.getPhoneNumber(), to);
+        }
+        waitlists.erase(from);
+        saveWaitlist();
+    }
+    keysLoaded = false;  // the pairs are re-read under the new name on the next registration
+}
+
+void RegistrationIndex::beginBatch() {
+    if (FileStamp::of(path).size != expectedSize) stale = true;
+    batchFile.open(path, ios::app);
+}
+
+void RegistrationIndex::endBatch() {
+    if (!batchFile.is_open()) return;
+    batchFile.close();
+    expectedSize = FileStamp::of(path).size;
+}
+
+// EventManagementSystem class definitions
+EventManagementSystem::EventManagementSystem(const string& eventsPath, const string& participantsPath,
+                                             const string& venuesPath)
+    : store(eventsPath), registrations(participantsPath), venues(VenueCatalogue::load(venuesPath)) {
+    store.load();
+    registrations.load();
+}
+
+void EventManagementSystem::run() {
+    while (true) {
+        try {
+            int role;
+            cout << "\n1. Are you an Organizer?\n2. Are you a Participant?\n0. Exit\nEnter your choice: ";
+            cin >> role;
+            cout << endl;
+            if (cin.fail()) {
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                throw invalid_argument("Invalid input. Please enter a number.");
+            }
+
+            switch (role) {
+                case 1:
+                    organizerMenu();
+                    break;
+                case 2:
+                    participantMenu();
+                    break;
+                case 0:
+                    return;
+                default:
+                    throw invalid_argument("Invalid choice. Please enter 0, 1, or 2.");
+            }
+        } catch (const invalid_argument& e) {
+            cerr << e.what() << endl;
+        }
+    }
+}
+
+void EventManagementSystem::validateDate(const string& date) {
+    DateParts parts;
+    if (!DateTimeParser::parseDate(date, parts)) {
+        throw invalid_argument("Invalid date format. Please enter the date in YYYY-MM-DD format.");
+    }
+
+    int year = parts.year;
+    int month = parts.month;
+    int day = parts.day;
+
+    if (year < 1900 || year > 2100) {
+        throw invalid_argument("Invalid year. Year must be between 1900 and 2100.");
+    }
+    if (month < 1 || month > 12) {
+        throw invalid_argument("Invalid month. Month must be between 01 and 12.");
+    }
+
+    int maxDay = DateTimeParser::daysInMonth(year, month);
+    if (day < 1 || day > maxDay) {
+        if (month == 2) {
+            throw invalid_argument("Invalid day. Day must be between 01 and 29 in a leap year and between 01 and 28 otherwise.");
+        }
+        throw invalid_argument("Invalid day. Day must be between 01 and " + to_string(maxDay) + ".");
+    }
+}
+
+void EventManagementSystem::validateTime(const string& startTime, const string& endTime) {
+    TimeParts start, end;
+    if (DateTimeParser::parseTime(startTime, start) && DateTimeParser::parseTime(endTime, end)) {
+        int startHour = start.hour;
+        int endHour = end.hour;
+        int startMinute = start.minute;
+        int endMinute = end.minute;
+
+        if (startHour < 8 || startHour >= 16) {
+            throw invalid_argument("Please select a start time between 08:00 and 16:00.");
+        }
+        if (endHour < 8 || endHour >= 16 || (endHour == 16 && endMinute > 0)) {
+            throw invalid_argument("Please select an end time between 08:00 and 16:00.");
+        }
+        if (endHour < startHour || (endHour == startHour && endMinute <= startMinute)) {
+            throw invalid_argument("End time must be after start time.");
+        }
+    } else {
+        throw invalid_argument("Invalid time format. Please enter time in HH:MM format.");
+    }
+}
+
+// Accepts H:MM as well as HH:MM; callers validate the time first.
+string EventManagementSystem::roundTimeToNextInterval(const string& time) {
+    TimeParts parts;
+    DateTimeParser::parseTime(time, parts);
+    int hour = parts.hour;
+    int minute = parts.minute;
+
+    minute = ((minute + 14) / 15) * 15;  // Round up to the nearest 15 minutes
+    if (minute == 60) {
+        minute = 0;
+        hour += 1;
+    }
+
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d", hour, minute);
+    return string(buffer);
+}
+
+void EventManagementSystem::organizerMenu() {
+    while (true) {
+        try {
+            int choice;
+            cout << "\n1. Scheduled Events\n2. Add New Event\n3. Your Created Events\n4. Modify Event\n5. Delete Event\n6. Add Recurring Event\n0. Exit\nEnter your choice: ";
+            cin >> choice;
+            cout << endl;
+            if (cin.fail()) {
+                cin.clear();
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                throw invalid_argument("Invalid input. Please enter a number.");
+            }
+            if (choice == 0) break;
+
+            switch (choice) {
+                case 1:
+                    displayScheduledEvents();
+                    break;
+                case 2:
+                    addNewEvent();
+                    break;
+                case 3:
+                    displayCreatedEvents();
+                    break;
+                case 4:
+                    modifyEvent();
+                    break;
+                case 5:
+                    deleteEvent();
+                    break;
+                case 6:
+                    addRecurringEvent();
+                    break;
+                default:
+                    throw invalid_argument("Invalid choice. Please enter a number between 0 and 6.");
+            }
+        } catch (const invalid_argument& e) {
+            cerr << e.what() << endl;
+        }
+    }
+}
+
+void EventManagementSystem::displayScheduledEvents() {
+    if (store.table().empty()) {
+        cout << "No events scheduled yet.\n";
+        return;
+    }
+
+    try {
+        int categoryChoice;
+        cout << "\nChoose a category:\n1. Workshop\n2. Seminar\n3. Lecture\n4. Exam\n5. Formal Event\n6. Miscellaneous\nEnter your choice: ";
+        cin >> categoryChoice;
+        cout << endl;
+        if (cin.fail()) {
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+
+        string category;
+        switch (categoryChoice) {
+            case 1: category = "Workshop"; break;
+            case 2: category = "Seminar"; break;
+            case 3: category = "Lecture"; break;
+            case 4: category = "Exam"; break;
+            case 5: category = "Formal Event"; break;
+            case 6: category = "Miscellaneous"; break;
+            default: throw invalid_argument("Invalid choice. Please enter a number between 1 and 6.");
+        }
+
+        string sort = askSortOrder();
+        EventStore::Query query;
+        query.field = EventStore::Query::Category;
+        query.value = category;
+        pageThrough(query, sort, Stats::DisplayCategory, "No event scheduled yet for this category.");
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::addNewEvent() {
+    string name, organizer, category, date, startTime, endTime, venue;
+    int seats;
+
+    try {
+        cout << "\nEnter event name: ";
+        cin.ignore();
+        getline(cin, name);
+
+        if (!isEventNameUnique(name)) {
+            throw invalid_argument("An event with this name already exists.");
+        }
+
+        cout << "Enter Organizer's Name: ";
+        getline(cin, organizer);
+
+        int categoryChoice;
+        cout << "Choose a category:\n1. Workshop\n2. Seminar\n3. Lecture\n4. Exam\n5. Formal Event\n6. Miscellaneous\nEnter your choice: ";
+        cin >> categoryChoice;
+        cout << endl;
+        if (cin.fail()) {
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+
+        switch (categoryChoice) {
+            case 1: category = "Workshop"; break;
+            case 2: category = "Seminar"; break;
+            case 3: category = "Lecture"; break;
+            case 4: category = "Exam"; break;
+            case 5: category = "Formal Event"; break;
+            case 6: category = "Miscellaneous"; break;
+            default: throw invalid_argument("Invalid choice. Returning to previous menu.");
+        }
+
+        cout << "Enter event date (YYYY-MM-DD): ";
+        cin.ignore();
+        while (true) {
+            getline(cin, date);
+            try {
+                validateDate(date);
+                break;
+            } catch (const invalid_argument& e) {
+                cerr << e.what() << endl;
+                cout << "Enter event date (YYYY-MM-DD): ";
+            }
+        }
+
+        while (true) {
+            try {
+                cout << "Enter event start time (HH:MM): ";
+                getline(cin, startTime);
+                cout << "Enter event end time (HH:MM): ";
+                getline(cin, endTime);
+                validateTime(startTime, endTime);
+                startTime = roundTimeToNextInterval(startTime);
+                endTime = roundTimeToNextInterval(endTime);
+                break;
+            } catch (const invalid_argument& e) {
+                cerr << e.what() << endl;
+            }
+        }
+
+        cout << "Enter number of seats: ";
+        cin >> seats;
+        cout << endl;
+        if (cin.fail()) {
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+
+        while (true) {
+            try {
+                venue = allocateVenue(DateTimeParser::parseDayNumber(date), DateTimeParser::parseMinutes(startTime),
+                                      DateTimeParser::parseMinutes(endTime), seats);
+                cout << "Venue allocated: " << venue << endl;
+                break;
+            } catch (const invalid_argument& e) {
+                cerr << e.what() << endl;
+
+                int day = DateTimeParser::parseDayNumber(date);
+                int duration = DateTimeParser::parseMinutes(endTime) - DateTimeParser::parseMinutes(startTime);
+                vector<EventStore::FreeSlot> options;
+                if (seats > 0) options = findSlots(seats, duration, day, day + 13, 5);
+                if (!options.empty()) {
+                    cout << "The earliest free times in the next two weeks are:\n";
+                    for (size_t i = 0; i < options.size(); ++i) {
+                        cout << i + 1 << ". " << DateTimeParser::formatDate(options[i].day) << " "
+                             << DateTimeParser::formatTime(options[i].startMinute) << " - "
+                             << DateTimeParser::formatTime(options[i].startMinute + duration) << " in " << options[i].venue << "\n";
+                    }
+                    cout << "Choose one, or enter 0 to pick another time yourself: ";
+                    size_t pick;
+                    cin >> pick;
+                    if (cin.fail()) {
+                        cin.clear();
+                        pick = 0;
+                    }
+                    if (pick >= 1 && pick <= options.size()) {
+                        const EventStore::FreeSlot& option = options[pick - 1];
+                        date = DateTimeParser::formatDate(option.day);
+                        startTime = DateTimeParser::formatTime(option.startMinute);
+                        endTime = DateTimeParser::formatTime(option.startMinute + duration);
+                        venue = option.venue;
+                        cout << "Venue allocated: " << venue << endl;
+                        break;
+                    }
+                }
+                cout << "Please choose a different time frame." << endl;
+
+                while (true) {
+                    try {
+                        cout << "Enter event start time (HH:MM): ";
+                        cin.ignore();
+                        getline(cin, startTime);
+                        cout << "Enter event end time (HH:MM): ";
+                        getline(cin, endTime);
+                        validateTime(startTime, endTime);
+                        startTime = roundTimeToNextInterval(startTime);
+                        endTime = roundTimeToNextInterval(endTime);
+                        break;
+                    } catch (const invalid_argument& e) {
+                        cerr << e.what() << endl;
+                    }
+                }
+            }
+        }
+
+        Event event(name, organizer, category, date, startTime, endTime, seats, venue);
+        store.add(event);
+        cout << "\nEvent successfully registered with the following details:\n";
+        event.display();
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::addRecurringEvent() {
+    string name, organizer, category, date, startTime, endTime, seats, repeat, end;
+
+    try {
+        cout << "\nEnter event name: ";
+        cin.ignore();
+        getline(cin, name);
+        cout << "Enter Organizer's Name: ";
+        getline(cin, organizer);
+        cout << "Enter category (Workshop, Seminar, Lecture, Exam, Formal Event, Miscellaneous): ";
+        getline(cin, category);
+        cout << "Enter the first date (YYYY-MM-DD): ";
+        getline(cin, date);
+        cout << "Enter event start time (HH:MM): ";
+        getline(cin, startTime);
+        cout << "Enter event end time (HH:MM): ";
+        getline(cin, endTime);
+        cout << "Enter number of seats: ";
+        getline(cin, seats);
+        cout << "Repeat:\n1. Weekly\n2. Every two weeks\nEnter your choice: ";
+        getline(cin, repeat);
+        cout << "Enter the last date (YYYY-MM-DD), or the number of occurrences: ";
+        getline(cin, end);
+
+        int seatCount;
+        if (!FieldScanner::toInt(seats, seatCount)) {
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+        if (repeat != "1" && repeat != "2") {
+            throw invalid_argument("Invalid choice. Please enter 1 or 2.");
+        }
+        end = (end.find('-') == string::npos ? "count=" : "until=") + end;
+        EventSeries entry = scheduleSeries(prepareSeries(name, organizer, category, date, startTime, endTime, seatCount,
+                                                         repeat == "1" ? "weekly" : "biweekly", end));
+        cout << "\nSeries booked in " << entry.first.getVenue() << ": " << entry.count << " occurrences from "
+             << entry.first.getDate() << " to " << DateTimeParser::formatDate(entry.lastDay()) << ".\n";
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::displayCreatedEvents() {
+    if (store.table().empty()) {
+        cout << "No events scheduled yet.\n";
+        return;
+    }
+
+    string currentOrganizer;
+
+    cout << "\nEnter Organizer Name: ";
+    cin.ignore();
+    getline(cin, currentOrganizer);
+
+    Stats::Timer timer(Stats::DisplayOrganizer);
+    EventStore::Query query;
+    query.field = EventStore::Query::Organizer;
+    query.value = currentOrganizer;
+    EventTable matches = selectEvents(query, Listing());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        matches.row(i).display();
+        cout << "Registered Participants: " << registrations.count(string(matches.name(i))) << endl;
+    }
+
+    if (matches.empty()) {
+        cout << "No events found for this organizer.\n";
+    }
+}
+
+void EventManagementSystem::participantMenu() {
+    try {
+        int choice;
+        cout << "\n1. Scheduled Events\n2. Register for an Event\n3. Cancel a Registration\n4. Events Between Dates\n0. Exit\nEnter your choice: ";
+        cin >> choice;
+        cout << endl;
+        if (cin.fail()) {
+            cin.clear();
+            cin.ignore(numeric_limits<streamsize>::max(), '\n');
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+        if (choice == 0) return;
+
+        switch (choice) {
+            case 1:
+                displayEventsForParticipants();
+                break;
+            case 2:
+                registerForEvent();
+                break;
+            case 3:
+                cancelRegistration();
+                break;
+            case 4:
+                displayEventsBetweenDates();
+                break;
+            default:
+                throw invalid_argument("Invalid choice. Returning to previous menu.");
+        }
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::displayEventsForParticipants() {
+    if (store.table().empty()) {
+        cout << "No events found.\n";
+        return;
+    }
+
+    try {
+        string sort = askSortOrder();
+        pageThrough(EventStore::Query(), sort, Stats::DisplayAll, "No events found.");
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::displayEventsBetweenDates() {
+    try {
+        string from, to, venue;
+        cout << "\nEnter the first date (YYYY-MM-DD): ";
+        cin.ignore();
+        getline(cin, from);
+        validateDate(from);
+        cout << "Enter the last date (YYYY-MM-DD): ";
+        getline(cin, to);
+        validateDate(to);
+        cout << "Enter a venue, or leave blank for all venues: ";
+        getline(cin, venue);
+
+        EventStore::Query query;
+        query.firstDay = DateTimeParser::parseDayNumber(from);
+        query.lastDay = DateTimeParser::parseDayNumber(to);
+        if (!venue.empty()) {
+            query.field = EventStore::Query::Venue;
+            query.value = venue;
+        }
+        cout << endl;
+        EventTable rows;
+        {
+            Stats::Timer timer(Stats::DisplayRange);
+            rows = selectEvents(query, Listing{"date"});
+        }
+        if (rows.empty()) {
+            cout << "No events found between these dates." << endl;
+        } else {
+            displayEventsTable(rows);
+        }
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::registerForEvent() {
+    string name, rollNumber, department, phoneNumber, eventName;
+
+    try {
+        cout << "\nEnter the event name you want to register for: ";
+        cin.ignore();
+        getline(cin, eventName);
+
+        if (!registrable(eventName)) {
+            throw invalid_argument("Error: The event \"" + eventName + "\" does not exist.");
+        }
+
+        cout << "Enter your name: ";
+        getline(cin, name);
+        cout << "Enter your roll number: ";
+        getline(cin, rollNumber);
+        cout << "Enter your department: ";
+        getline(cin, department);
+        cout << "Enter your phone number: ";
+        getline(cin, phoneNumber);
+
+        Participant participant(name, rollNumber, department, phoneNumber, eventName);
+        RegistrationIndex::Outcome outcome = enrolParticipant(participant);
+        if (outcome.waitlisted) {
+            cout << "The event is full. You are number " << outcome.position
+                 << " on the waitlist and will get a seat if one frees up.\n";
+        } else {
+            cout << "Successfully registered for the event.\n";
+        }
+    } catch (const invalid_argument& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::cancelRegistration() {
+    string eventName, rollNumber;
+
+    try {
+        cout << "\nEnter the event name: ";
+        cin.ignore();
+        getline(cin, eventName);
+        cout << "Enter your roll number: ";
+        getline(cin, rollNumber);
+
+        RegistrationIndex::Cancellation result = withdrawParticipant(eventName, rollNumber);
+        cout << "Registration cancelled.\n";
+        for (const auto& promoted : result.promoted) {
+            cout << promoted.getName() << " (" << promoted.getRollNumber() << ") moved from the waitlist to a seat.\n";
+        }
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+    }
+}
+
+const VenueCatalogue& EventManagementSystem::venueCatalogue() const { return venues; }
+
+vector<EventStore::FreeSlot> EventManagementSystem::findSlots(int seats, int durationMinutes, int firstDay, int lastDay,
+                                                              size_t limit) {
+    Stats::Timer timer(Stats::Allocate);
+    if (seats <= 0) throw invalid_argument("Number of seats must be positive.");
+    if (durationMinutes <= 0 || durationMinutes > EventStore::SLOT_COUNT * EventStore::SLOT_MINUTES) {
+        throw invalid_argument("Duration must be between 1 and " + to_string(EventStore::SLOT_COUNT * EventStore::SLOT_MINUTES) + " minutes.");
+    }
+    if (lastDay < firstDay || lastDay - firstDay >= MAX_SLOT_SEARCH_DAYS) {
+        throw invalid_argument("Search between 1 and " + to_string(MAX_SLOT_SEARCH_DAYS) + " days.");
+    }
+    vector<string> candidates;
+    for (auto venue = venues.firstFitting(seats); venue != venues.all().end(); ++venue) {
+        candidates.push_back(venue->name);  // smallest first, so each start gets the best fit
+    }
+    int slotCount = (durationMinutes + EventStore::SLOT_MINUTES - 1) / EventStore::SLOT_MINUTES;
+    return store.earliestFree(candidates, firstDay, lastDay, slotCount, limit);
+}
+
+// Venues are sorted by capacity, so the first free one wastes the fewest seats.
+string EventManagementSystem::allocateVenue(int day, int startMinute, int endMinute, int seats, const Event* ignore) {
+    Stats::Timer timer(Stats::Allocate);
+    for (auto venue = venues.firstFitting(seats); venue != venues.all().end(); ++venue) {
+        if (isRoomAvailable(day, startMinute, endMinute, venue->name, ignore)) {
+            return venue->name;
+        }
+    }
+    throw invalid_argument("No suitable room available for the given date and time.");
+}
+
+void EventManagementSystem::deleteEvent() {
+    try {
+        string eventName;
+        cout << "\nEnter the name of the event you want to delete: ";
+        cin.ignore();
+        getline(cin, eventName);
+
+        bool eventFound = store.remove(eventName) || store.removeSeries(eventName);
+
+        if (eventFound) {
+            cout << "Event \"" << eventName << "\" deleted successfully." << endl;
+        } else {
+            cout << "Event \"" << eventName << "\" not found." << endl;
+        }
+    } catch (const exception& e) {
+        cerr << "Error deleting event: " << e.what() << endl;
+    }
+}
+
+void EventManagementSystem::modifyEvent() {
+    try {
+        string eventName;
+        cout << "\nEnter the name of the event you want to modify: ";
+        cin.ignore();
+        getline(cin, eventName);
+
+        optional<Event> currentEvent = store.find(eventName);
+        if (!currentEvent) {
+            throw invalid_argument("Event \"" + eventName + "\" not found.");
+        }
+
+        Event modifiedEvent = *currentEvent;
+
+        cout << "Enter new details (leave empty to keep current value):\n";
+        string input;
+
+        cout << "Event Name [" << modifiedEvent.getName() << "]: ";
+        getline(cin, input);
+        if (!input.empty() && input != eventName && !isEventNameUnique(input)) {
+            throw invalid_argument("An event with this name already exists.");
+        }
+        if (!input.empty()) modifiedEvent = Event(input, modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+
+        cout << "Organizer [" << modifiedEvent.getOrganizer() << "]: ";
+        getline(cin, input);
+        if (!input.empty()) modifiedEvent = Event(modifiedEvent.getName(), input, modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+
+        cout << "Category [" << modifiedEvent.getCategory() << "]: ";
+        getline(cin, input);
+        if (!input.empty()) modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), input, modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+
+        cout << "Date [" << modifiedEvent.getDate() << "]: ";
+        getline(cin, input);
+        if (!input.empty()) {
+            validateDate(input);
+            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), input, modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+        }
+
+        cout << "Start Time [" << modifiedEvent.getStartTime() << "]: ";
+        getline(cin, input);
+        if (!input.empty()) {
+            validateTime(input, modifiedEvent.getEndTime());
+            input = roundTimeToNextInterval(input);
+            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), input, modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+        }
+
+        cout << "End Time [" << modifiedEvent.getEndTime() << "]: ";
+        getline(cin, input);
+        if (!input.empty()) {
+            validateTime(modifiedEvent.getStartTime(), input);
+            input = roundTimeToNextInterval(input);
+            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), input, modifiedEvent.getSeats(), modifiedEvent.getVenue());
+        }
+
+        cout << "Seats [" << modifiedEvent.getSeats() << "]: ";
+        getline(cin, input);
+        if (!input.empty()) {
+            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), stoi(input), "");
+            try {
+                string allocatedVenue = allocateVenue(modifiedEvent.getDay(), modifiedEvent.getStartMinute(), modifiedEvent.getEndMinute(), modifiedEvent.getSeats(), &*currentEvent);
+                cout << "Venue allocated: " << allocatedVenue << endl;
+                modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), allocatedVenue);
+            } catch (const invalid_argument& e) {
+                cerr << e.what() << endl;
+                return;
+            }
+        }
+
+        if (store.update(eventName, modifiedEvent)) {
+            cout << "Event modified successfully." << endl;
+            registrations.renameEvent(eventName, modifiedEvent.getName());
+            for (const auto& promoted : registrations.promote(modifiedEvent.getName(), modifiedEvent.getSeats())) {
+                cout << promoted.getName() << " (" << promoted.getRollNumber() << ") moved from the waitlist to a seat." << endl;
+            }
+        }
+    } catch (const exception& e) {
+        cerr << "Error modifying event: " << e.what() << endl;
     }
 }
 
-string EventManagementSystem::roundTimeToNextInterval(const string& time) {
-    int hour = stoi(time.substr(0, 2));
-    int minute = stoi(time.substr(3, 2));
+bool EventManagementSystem::isRoomAvailable(int day, int startMinute, int endMinute, const string& room, const Event* ignore) {
+    return store.isSlotFree(room, day, EventStore::slotMask(startMinute, endMinute), ignore);
+}
 
-    minute = ((minute + 14) / 15) * 15;  // Round up to the nearest 15 minutes
-    if (minute == 60) {
-        minute = 0;
-        hour += 1;
+// The table is rendered into one buffer and written with a single flush.
+// Cells are padded by hand, as setw would, which is much cheaper than
+// formatting through a stream.
+void EventManagementSystem::displayEventsTable(const EventTable& events) {
+    string table;
+    table.reserve((events.size() + 2) * 128);
+    auto cell = [&table](string_view text, size_t width) {
+        table += text;
+        if (text.size() < width) table.append(width - text.size(), ' ');
+    };
+    cell("Event Name", 20);
+    cell("Organizer", 20);
+    cell("Date", 12);
+    cell("Time", 20);
+    cell("Venue", 20);
+    cell("Seats", 8);
+    table += "Registered Participants\n";
+    table.append(20 + 20 + 12 + 20 + 20 + 8 + 25, '-');
+    table += '\n';
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events.isErased(i)) continue;
+        string name(events.name(i));
+        int registeredParticipants = registrations.count(name);
+        cell(name, 20);
+        cell(StringPool::lookup(events.organizer(i)), 20);
+        cell(DateTimeParser::formatDate(events.day(i)), 12);
+        cell(DateTimeParser::formatTime(events.startMinute(i)) + " - " + DateTimeParser::formatTime(events.endMinute(i)), 20);
+        cell(StringPool::lookup(events.venue(i)), 20);
+        cell(to_string(events.seats(i)), 8);
+        table += to_string(registeredParticipants);
+        table += '\n';
     }
+    cout << table << flush;
+}
 
-    char buffer[6];
-    snprintf(buffer, sizeof(buffer), "%02d:%02d", hour, minute);
-    return string(buffer);
+EventManagementSystem::Listing EventManagementSystem::parseListing(const vector<string>& fields, size_t first) {
+    Listing listing;
+    for (size_t i = first; i < fields.size(); ++i) {
+        size_t eq = fields[i].find('=');
+        string key = fields[i].substr(0, eq);
+        string value = eq == string::npos ? "" : fields[i].substr(eq + 1);
+        int number;
+        if (key == "sort" && (value == "date" || value == "start" || value == "venue" || value == "fill")) {
+            listing.sort = value;
+        } else if ((key == "limit" || key == "offset") && FieldScanner::toInt(value, number) && number >= 0) {
+            (key == "limit" ? listing.limit : listing.offset) = number;
+        } else {
+            throw invalid_argument("Unknown query option \"" + fields[i] + "\".");
+        }
+    }
+    return listing;
 }
 
-void EventManagementSystem::organizerMenu() {
-    while (true) {
-        try {
-            int choice;
-            cout << "\n1. Scheduled Events\n2. Add New Event\n3. Your Created Events\n4. Modify Event\n5. Delete Event\n0. Exit\nEnter your choice: ";
-            cin >> choice;
-            cout << endl;
-            if (cin.fail()) {
-                cin.clear();
-                cin.ignore(numeric_limits<streamsize>::max(), '\n');
-                throw invalid_argument("Invalid input. Please enter a number.");
+string EventManagementSystem::askSortOrder() {
+    int sortChoice;
+    cout << "Sort by:\n1. Date\n2. Start time\n3. Venue\n4. Fill ratio\n0. As entered\nEnter your choice: ";
+    cin >> sortChoice;
+    cout << endl;
+    if (cin.fail()) {
+        cin.clear();
+        cin.ignore(numeric_limits<streamsize>::max(), '\n');
+        throw invalid_argument("Invalid input. Please enter a number.");
+    }
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    switch (sortChoice) {
+        case 0: return "";
+        case 1: return "date";
+        case 2: return "start";
+        case 3: return "venue";
+        case 4: return "fill";
+        default: throw invalid_argument("Invalid choice. Please enter a number between 0 and 4.");
+    }
+}
+
+// Listing everything in date, start time or venue order walks the store's
+// ordered indexes and stops once the page is full. Recurring series are
+// listed as their occurrences; there are few of them next to the events, so
+// they are sorted on their own and merged into the walk. Narrower queries
+// read their matches from a secondary index, already in date order, and sort
+// only those. Fill ratio changes with every registration, so it is never
+// indexed. Other orders use a partial sort that stops at the end of the page.
+// A date-range query with no sort given is listed in date order.
+EventTable EventManagementSystem::selectEvents(const EventStore::Query& query, const Listing& listing) {
+    EventTable page;
+    if (listing.limit == 0) return page;
+    const EventTable& stored = store.table();
+
+    // A match is a row of the store's table or of `extra`, which holds the
+    // series occurrences. Ties are broken by `rank`: stored order, with the
+    // occurrences after every stored event.
+    struct Match {
+        const EventTable* table;
+        uint32_t row;
+        size_t rank;
+        double fill;  // only worked out for sort=fill, once per match
+    };
+    EventTable extra;
+    store.forEachOccurrence(query, [&](const Event& event) {
+        extra.append(event);
+        return true;
+    });
+    auto match = [&](const EventTable* table, size_t row, size_t rank) {
+        double fill = 0.0;
+        if (listing.sort == "fill" && table->seats(row) > 0) {
+            fill = double(registrations.count(string(table->name(row)))) / table->seats(row);
+        }
+        return Match{table, uint32_t(row), rank, fill};
+    };
+
+    bool ranged = query.firstDay != INT_MIN || query.lastDay != INT_MAX;
+    bool dateOrder = listing.sort == "date" || (listing.sort.empty() && ranged);
+    function<bool(const Match&, const Match&)> before;
+    if (dateOrder) {
+        before = [](const Match& a, const Match& b) {
+            return make_tuple(a.table->day(a.row), a.table->startMinute(a.row), a.rank)
+                 < make_tuple(b.table->day(b.row), b.table->startMinute(b.row), b.rank);
+        };
+    } else if (listing.sort == "fill") {
+        before = [](const Match& a, const Match& b) {
+            if (a.fill != b.fill) return a.fill > b.fill;
+            return make_tuple(a.table->day(a.row), a.table->startMinute(a.row), a.rank)
+                 < make_tuple(b.table->day(b.row), b.table->startMinute(b.row), b.rank);
+        };
+    } else if (listing.sort == "start") {
+        before = [](const Match& a, const Match& b) {
+            return make_tuple(a.table->startMinute(a.row), a.table->day(a.row), a.rank)
+                 < make_tuple(b.table->startMinute(b.row), b.table->day(b.row), b.rank);
+        };
+    } else if (listing.sort == "venue") {
+        before = [](const Match& a, const Match& b) {
+            const string& venueA = StringPool::lookup(a.table->venue(a.row));
+            const string& venueB = StringPool::lookup(b.table->venue(b.row));
+            if (venueA != venueB) return venueA < venueB;
+            return make_tuple(a.table->day(a.row), a.table->startMinute(a.row), a.rank)
+                 < make_tuple(b.table->day(b.row), b.table->startMinute(b.row), b.rank);
+        };
+    } else {
+        before = [](const Match& a, const Match& b) { return a.rank < b.rank; };
+    }
+
+    if (query.everything() && listing.sort != "fill") {
+        EventStore::Order order = listing.sort == "date" ? EventStore::Order::Date
+                                : listing.sort == "start" ? EventStore::Order::Start
+                                : listing.sort == "venue" ? EventStore::Order::Venue
+                                : EventStore::Order::Stored;
+        vector<Match> occurrences;
+        for (size_t i = 0; i < extra.size(); ++i) occurrences.push_back(match(&extra, i, stored.size() + i));
+        sort(occurrences.begin(), occurrences.end(), before);
+        size_t skipped = 0, next = 0;
+        auto emit = [&](const Match& m) {
+            if (skipped < listing.offset) {
+                ++skipped;
+                return true;
             }
-            if (choice == 0) break;
+            page.append(*m.table, m.row);
+            return page.size() < listing.limit;
+        };
+        bool more = true;
+        store.forEach(order, [&](size_t row) {
+            Match current = match(&stored, row, row);
+            while (more && next < occurrences.size() && before(occurrences[next], current)) more = emit(occurrences[next++]);
+            return more && (more = emit(current));
+        });
+        while (more && next < occurrences.size()) more = emit(occurrences[next++]);
+        return page;
+    }
 
-            switch (choice) {
-                case 1:
-                    displayScheduledEvents();
-                    break;
-                case 2:
-                    addNewEvent();
-                    break;
-                case 3:
-                    displayCreatedEvents();
-                    break;
-                case 4:
-                    modifyEvent();
-                    break;
-                case 5:
-                    deleteEvent();
-                    break;
-                default:
-                    throw invalid_argument("Invalid choice. Please enter 0, 1, 2, 3, 4, or 5.");
+    // Without occurrences to mix in, date order is the order select() visits
+    // in, and it can stop at the end of the page.
+    bool indexOrder = dateOrder && extra.empty();
+    vector<Match> matches;
+    store.select(query, [&](size_t row) {
+        matches.push_back(match(&stored, row, row));
+        return !indexOrder || matches.size() <= listing.offset || matches.size() - listing.offset < listing.limit;
+    });
+    for (size_t i = 0; i < extra.size(); ++i) matches.push_back(match(&extra, i, stored.size() + i));
+    if (listing.offset >= matches.size()) return page;
+    size_t end = listing.offset + min(listing.limit, matches.size() - listing.offset);
+    if (!indexOrder) partial_sort(matches.begin(), matches.begin() + end, matches.end(), before);
+    page.reserve(end - listing.offset, 0);
+    for (size_t i = listing.offset; i < end; ++i) page.append(*matches[i].table, matches[i].row);
+    return page;
+}
+
+// Shows one page at a time. Each page asks for one row more than it shows,
+// to know whether to offer the next page.
+void EventManagementSystem::pageThrough(const EventStore::Query& query, const string& sort,
+                                        Stats::Operation operation, const string& emptyMessage) {
+    Listing listing{sort, 0, PAGE_SIZE + 1};
+    while (true) {
+        bool more;
+        {
+            Stats::Timer timer(operation);
+            EventTable rows = selectEvents(query, listing);
+            if (rows.empty()) {
+                if (listing.offset == 0) cout << emptyMessage << endl;
+                return;
             }
-        } catch (const invalid_argument& e) {
-            cerr << e.what() << endl;
+            more = rows.size() > PAGE_SIZE;
+            if (more) rows.erase(PAGE_SIZE);
+            displayEventsTable(rows);
         }
+        if (!more) return;
+
+        string answer;
+        cout << "Press Enter for the next page, or type q to stop: ";
+        if (!getline(cin, answer) || !answer.empty()) return;
+        listing.offset += PAGE_SIZE;
     }
 }
 
-void EventManagementSystem::displayScheduledEvents() {
-    vector<Event> events = Event::loadAll();
-    if (events.empty()) {
-        cout << "No events scheduled yet.\n";
-        return;
+void EventManagementSystem::printHeader(const string& title) {
+    int terminalWidth = 80; // Assume default terminal width
+    int titleWidth = title.size();
+    int leftPadding = (terminalWidth - titleWidth) / 2;
+    cout << setw(leftPadding) << "" << title << endl;
+}
+
+bool EventManagementSystem::isValidDateFormat(const string &date) {
+    DateParts parts;
+    if (!DateTimeParser::parseDate(date, parts)) {
+        return false;
     }
+    return parts.day >= 1 && parts.day <= DateTimeParser::daysInMonth(parts.year, parts.month);
+}
 
-    map<string, int> participantCount = Participant::countByEvent();
+bool EventManagementSystem::isEventNameUnique(const string& eventName) {
+    return !store.contains(eventName) && store.findSeries(eventName) == nullptr;
+}
 
-    try {
-        int categoryChoice;
-        cout << "\nChoose a category:\n1. Workshop\n2. Seminar\n3. Lecture\n4. Exam\n5. Formal Event\n6. Miscellaneous\nEnter your choice: ";
-        cin >> categoryChoice;
-        cout << endl;
-        if (cin.fail()) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            throw invalid_argument("Invalid input. Please enter a number.");
-        }
+bool EventManagementSystem::isValidCategory(const string& category) { return Event::isCategory(category); }
 
-        string category;
-        switch (categoryChoice) {
-            case 1: category = "Workshop"; break;
-            case 2: category = "Seminar"; break;
-            case 3: category = "Lecture"; break;
-            case 4: category = "Exam"; break;
-            case 5: category = "Formal Event"; break;
-            case 6: category = "Miscellaneous"; break;
-            default: throw invalid_argument("Invalid choice. Please enter a number between 1 and 6.");
-        }
+// Validates a new event and returns it with its times rounded and no venue yet.
+Event EventManagementSystem::prepareEvent(const string& name, const string& organizer, const string& category,
+                                          const string& date, string startTime, string endTime, int seats) {
+    if (name.empty()) {
+        throw invalid_argument("Event name cannot be empty.");
+    }
+    if (!isEventNameUnique(name)) {
+        throw invalid_argument("An event with this name already exists.");
+    }
+    if (!isValidCategory(category)) {
+        throw invalid_argument("Invalid category \"" + category + "\".");
+    }
+    validateDate(date);
+    validateTime(startTime, endTime);
+    startTime = roundTimeToNextInterval(startTime);
+    endTime = roundTimeToNextInterval(endTime);
+    if (seats <= 0) {
+        throw invalid_argument("Number of seats must be positive.");
+    }
+    return Event(name, organizer, category, date, startTime, endTime, seats, "");
+}
 
-        vector<Event> filteredEvents;
-        for (const auto& event : events) {
-            if (event.getCategory() == category) {
-                filteredEvents.push_back(event);
-            }
+Event EventManagementSystem::scheduleEvent(const string& name, const string& organizer, const string& category,
+                                           const string& date, string startTime, string endTime, int seats) {
+    Event prepared = prepareEvent(name, organizer, category, date, startTime, endTime, seats);
+    string venue = allocateVenue(prepared.getDay(), prepared.getStartMinute(), prepared.getEndMinute(), seats);
+    Event event(name, organizer, category, prepared.getDay(), prepared.getStartMinute(), prepared.getEndMinute(), seats, venue);
+    store.add(event);
+    return event;
+}
+
+void EventManagementSystem::setAllocationBudget(chrono::milliseconds budget) {
+    allocationBudget = budget;
+}
+
+// Unlike the interactive flow, any change to the date, times or seats
+// re-allocates the venue, so a moved event cannot land on a booked room.
+Event EventManagementSystem::changeEvent(const string& eventName, const vector<pair<string, string>>& changes) {
+    optional<Event> current = store.find(eventName);
+    if (!current) {
+        throw invalid_argument("Event \"" + eventName + "\" not found.");
+    }
+    Event modified = planChange(*current, changes);
+    store.update(eventName, modified);
+    registrations.renameEvent(eventName, modified.getName());
+    registrations.promote(modified.getName(), modified.getSeats());
+    return modified;
+}
+
+// Checks the repeat and end and builds the series, without booking a room.
+EventSeries EventManagementSystem::prepareSeries(const string& name, const string& organizer, const string& category,
+                                                const string& date, const string& startTime, const string& endTime,
+                                                int seats, const string& repeat, const string& end) {
+    Event first = prepareEvent(name, organizer, category, date, startTime, endTime, seats);
+    int interval;
+    if (repeat == "weekly") {
+        interval = 7;
+    } else if (repeat == "biweekly") {
+        interval = 14;
+    } else {
+        throw invalid_argument("Repeat must be \"weekly\" or \"biweekly\".");
+    }
+
+    int count;
+    if (end.compare(0, 6, "until=") == 0) {
+        validateDate(end.substr(6));
+        int lastDay = DateTimeParser::parseDayNumber(end.substr(6));
+        if (lastDay < first.getDay()) throw invalid_argument("The series must end on or after its first date.");
+        count = (lastDay - first.getDay()) / interval + 1;
+    } else if (end.compare(0, 6, "count=") != 0 || !FieldScanner::toInt(string_view(end).substr(6), count) || count <= 0) {
+        throw invalid_argument("End the series with until=YYYY-MM-DD or count=N.");
+    }
+    if (count > EventSeries::MAX_OCCURRENCES) {
+        throw invalid_argument("A series can have at most " + to_string(EventSeries::MAX_OCCURRENCES) + " occurrences.");
+    }
+    return EventSeries{first, interval, count};
+}
+
+// One venue is chosen for every occurrence: the smallest that is free on
+// all of them, each room checked in a single pass over its bookings.
+EventSeries EventManagementSystem::scheduleSeries(const EventSeries& prepared) {
+    Stats::Timer timer(Stats::Allocate);
+    const Event& p = prepared.first;
+    uint32_t mask = EventStore::slotMask(p.getStartMinute(), p.getEndMinute());
+    for (auto venue = venues.firstFitting(p.getSeats()); venue != venues.all().end(); ++venue) {
+        if (store.isSeriesFree(venue->name, p.getDay(), prepared.intervalDays, prepared.count, mask)) {
+            EventSeries entry{Event(p.getName(), p.getOrganizer(), p.getCategory(), p.getDay(), p.getStartMinute(),
+                                    p.getEndMinute(), p.getSeats(), venue->name),
+                              prepared.intervalDays, prepared.count};
+            store.addSeries(entry);
+            return entry;
         }
+    }
+    throw invalid_argument("No single room is free for every occurrence of the series.");
+}
+
+// Works out the modified event, allocating a new venue if needed, without
+// touching the store.
+Event EventManagementSystem::planChange(const Event& current, const vector<pair<string, string>>& changes) {
+    const string& eventName = current.getName();
+    string name = current.getName(), organizer = current.getOrganizer(), category = current.getCategory();
+    string date = current.getDate(), startTime = current.getStartTime(), endTime = current.getEndTime();
+    int seats = current.getSeats();
+    bool reallocate = false;
 
-        if (filteredEvents.empty()) {
-            cout << "No event scheduled yet for this category." << endl;
+    for (const auto& change : changes) {
+        const string& field = change.first;
+        const string& value = change.second;
+        if (field == "name") {
+            if (value.empty()) throw invalid_argument("Event name cannot be empty.");
+            if (value != eventName && !isEventNameUnique(value)) {
+                throw invalid_argument("An event with this name already exists.");
+            }
+            name = value;
+        } else if (field == "organizer") {
+            organizer = value;
+        } else if (field == "category") {
+            if (!isValidCategory(value)) throw invalid_argument("Invalid category \"" + value + "\".");
+            category = value;
+        } else if (field == "date") {
+            validateDate(value);
+            date = value;
+            reallocate = true;
+        } else if (field == "start") {
+            startTime = value;
+            reallocate = true;
+        } else if (field == "end") {
+            endTime = value;
+            reallocate = true;
+        } else if (field == "seats") {
+            if (!FieldScanner::toInt(value, seats) || seats <= 0) {
+                throw invalid_argument("Number of seats must be a positive number.");
+            }
+            reallocate = true;
         } else {
-            displayEventsTable(filteredEvents, participantCount);
+            throw invalid_argument("Unknown field \"" + field + "\".");
         }
-    } catch (const invalid_argument& e) {
-        cerr << e.what() << endl;
     }
+
+    string venue = current.getVenue();
+    if (reallocate) {
+        validateTime(startTime, endTime);
+        startTime = roundTimeToNextInterval(startTime);
+        endTime = roundTimeToNextInterval(endTime);
+        venue = allocateVenue(DateTimeParser::parseDayNumber(date), DateTimeParser::parseMinutes(startTime),
+                              DateTimeParser::parseMinutes(endTime), seats, &current);
+    }
+
+    return Event(name, organizer, category, date, startTime, endTime, seats, venue);
 }
 
-void EventManagementSystem::addNewEvent() {
-    string name, organizer, category, date, startTime, endTime, venue;
-    int seats;
+optional<Event> EventManagementSystem::registrable(const string& name) const {
+    if (optional<Event> event = store.find(name)) return event;
+    const EventSeries* entry = store.findSeries(name);
+    if (entry == nullptr) return nullopt;
+    return entry->first;  // one registration covers the whole series
+}
 
-    try {
-        cout << "\nEnter event name: ";
-        cin.ignore();
-        getline(cin, name);
+RegistrationIndex::Outcome EventManagementSystem::enrolParticipant(const Participant& participant) {
+    optional<Event> event = registrable(participant.getEventName());
+    if (!event) {
+        throw invalid_argument("Error: The event \"" + participant.getEventName() + "\" does not exist.");
+    }
+    return registrations.enrol(participant, event->getSeats());
+}
 
-        if (!isEventNameUnique(name)) {
-            throw invalid_argument("An event with this name already exists.");
-        }
+RegistrationIndex::Cancellation EventManagementSystem::withdrawParticipant(const string& eventName, const string& rollNumber) {
+    optional<Event> event = registrable(eventName);
+    if (!event) {
+        throw invalid_argument("Error: The event \"" + eventName + "\" does not exist.");
+    }
+    RegistrationIndex::Cancellation result = registrations.cancel(eventName, rollNumber, event->getSeats());
+    if (!result.found) {
+        throw invalid_argument("No registration for roll number " + rollNumber + " in \"" + eventName + "\".");
+    }
+    return result;
+}
 
-        cout << "Enter Organizer's Name: ";
-        getline(cin, organizer);
+// Batch input is one command per line with '|'-separated fields; blank lines
+// and lines starting with '#' are skipped:
+//
+//   add|NAME|ORGANIZER|CATEGORY|YYYY-MM-DD|HH:MM|HH:MM|SEATS
+//   modify|NAME|field=value|...      (name, organizer, category, date, start, end, seats)
+//   delete|NAME
+//   register|EVENT|NAME|ROLL NUMBER|DEPARTMENT|PHONE
+//   query|all  or  query|category|C  or  query|organizer|O  or  query|event|NAME
+//
+// Every command produces one tab-separated result line, "LINE OK COMMAND ..."
+// or "LINE ERR COMMAND MESSAGE"; a query is followed by one "LINE ROW ..."
+// line per matching event. Disk writes are buffered for the whole batch.
+// Consecutive adds are placed together by the VenueOptimizer.
+int EventManagementSystem::runBatch(istream& in, ostream& out) {
+    store.beginBatch();
+    registrations.beginBatch();
 
-        int categoryChoice;
-        cout << "Choose a category:\n1. Workshop\n2. Seminar\n3. Lecture\n4. Exam\n5. Formal Event\n6. Miscellaneous\nEnter your choice: ";
-        cin >> categoryChoice;
-        cout << endl;
-        if (cin.fail()) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            throw invalid_argument("Invalid input. Please enter a number.");
-        }
+    string line;
+    size_t lineNo = 0;
+    int failures = 0;
+    vector<pair<size_t, vector<string>>> adds;
+    while (getline(in, line)) {
+        ++lineNo;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
 
-        switch (categoryChoice) {
-            case 1: category = "Workshop"; break;
-            case 2: category = "Seminar"; break;
-            case 3: category = "Lecture"; break;
-            case 4: category = "Exam"; break;
-            case 5: category = "Formal Event"; break;
-            case 6: category = "Miscellaneous"; break;
-            default: throw invalid_argument("Invalid choice. Returning to previous menu.");
+        vector<string> fields = splitCommand(line);
+        if (fields[0] == "add") {
+            adds.emplace_back(lineNo, move(fields));
+            continue;
         }
+        failures += runBatchAdds(adds, out);
+        adds.clear();
 
-        cout << "Enter event date (YYYY-MM-DD): ";
-        cin.ignore();
-        while (true) {
-            getline(cin, date);
-            try {
-                validateDate(date);
-                break;
-            } catch (const invalid_argument& e) {
-                cerr << e.what() << endl;
-                cout << "Enter event date (YYYY-MM-DD): ";
-            }
+        try {
+            string result = runBatchCommand(fields, lineNo);
+            out << lineNo << "\tOK\t" << fields[0] << result << '\n';
+        } catch (const exception& e) {
+            ++failures;
+            out << lineNo << "\tERR\t" << fields[0] << '\t' << e.what() << '\n';
         }
+    }
+    failures += runBatchAdds(adds, out);
 
-        while (true) {
-            try {
-                cout << "Enter event start time (HH:MM): ";
-                getline(cin, startTime);
-                cout << "Enter event end time (HH:MM): ";
-                getline(cin, endTime);
-                validateTime(startTime, endTime);
-                startTime = roundTimeToNextInterval(startTime);
-                endTime = roundTimeToNextInterval(endTime);
-                break;
-            } catch (const invalid_argument& e) {
-                cerr << e.what() << endl;
+    store.endBatch();
+    registrations.endBatch();
+    out.flush();
+    return failures == 0 ? 0 : 2;
+}
+
+vector<string> EventManagementSystem::splitCommand(const string& line) {
+    vector<string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t bar = line.find('|', start);
+        fields.push_back(line.substr(start, bar == string::npos ? string::npos : bar - start));
+        if (bar == string::npos) break;
+        start = bar + 1;
+    }
+    return fields;
+}
+
+vector<pair<string, string>> EventManagementSystem::parseChanges(const vector<string>& fields) {
+    if (fields.size() < 3) throw invalid_argument("Expected NAME and at least one field=value.");
+    vector<pair<string, string>> changes;
+    for (size_t i = 2; i < fields.size(); ++i) {
+        size_t eq = fields[i].find('=');
+        if (eq == string::npos) throw invalid_argument("Expected field=value, got \"" + fields[i] + "\".");
+        changes.emplace_back(fields[i].substr(0, eq), fields[i].substr(eq + 1));
+    }
+    return changes;
+}
+
+// Validates a run of add commands, places all of them at once and reports
+// in input order. Returns the number of adds that failed.
+int EventManagementSystem::runBatchAdds(const vector<pair<size_t, vector<string>>>& adds, ostream& out) {
+    if (adds.empty()) return 0;
+
+    vector<Event> prepared;
+    vector<VenueOptimizer::Request> requests;
+    vector<string> errors(adds.size());
+    vector<int> requestOf(adds.size(), -1);
+    unordered_set<string> names;
+
+    for (size_t i = 0; i < adds.size(); ++i) {
+        const vector<string>& f = adds[i].second;
+        try {
+            int seats;
+            if (f.size() != 8) throw invalid_argument("Expected 7 fields after \"add\".");
+            if (!FieldScanner::toInt(f[7], seats)) throw invalid_argument("Invalid input. Please enter a number.");
+            Event event = prepareEvent(f[1], f[2], f[3], f[4], f[5], f[6], seats);
+            if (!names.insert(event.getName()).second) {
+                throw invalid_argument("An event with this name already exists.");
             }
+            requestOf[i] = requests.size();
+            requests.push_back({event.getDay(), EventStore::slotMask(event.getStartMinute(), event.getEndMinute()), seats});
+            prepared.push_back(event);
+        } catch (const invalid_argument& e) {
+            errors[i] = e.what();
         }
+    }
 
-        cout << "Enter number of seats: ";
-        cin >> seats;
-        cout << endl;
-        if (cin.fail()) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            throw invalid_argument("Invalid input. Please enter a number.");
+    vector<VenueOptimizer::Room> rooms;
+    for (const auto& venue : venues.all()) rooms.push_back({venue.name, venue.capacity});
+    VenueOptimizer optimizer(store, rooms, allocationBudget);
+    vector<int> placement = optimizer.place(requests);
+
+    int failures = 0;
+    for (size_t i = 0; i < adds.size(); ++i) {
+        int request = requestOf[i];
+        if (request >= 0 && placement[request] < 0) {
+            errors[i] = "No suitable room available for the given date and time.";
+        }
+        if (!errors[i].empty()) {
+            ++failures;
+            out << adds[i].first << "\tERR\tadd\t" << errors[i] << '\n';
+            continue;
         }
+        const Event& p = prepared[request];
+        Event event(p.getName(), p.getOrganizer(), p.getCategory(), p.getDay(), p.getStartMinute(), p.getEndMinute(),
+                    p.getSeats(), optimizer.room(placement[request]).name);
+        store.add(event);
+        out << adds[i].first << "\tOK\tadd\t" << event.getName() << '\t' << event.getDate() << '\t'
+            << event.getStartTime() << '\t' << event.getEndTime() << '\t' << event.getVenue() << '\t'
+            << event.getSeats() << '\n';
+    }
+    return failures;
+}
 
-        while (true) {
-            try {
-                venue = allocateVenue(date, startTime, endTime, seats);
-                cout << "Venue allocated: " << venue << endl;
-                break;
-            } catch (const invalid_argument& e) {
-                cerr << e.what() << endl;
-                cout << "Please choose a different time frame." << endl;
+// Returns the text that follows "LINE OK COMMAND" for a successful command.
+string EventManagementSystem::runBatchCommand(const vector<string>& fields, size_t lineNo) {
+    const string& command = fields[0];
+    auto expect = [&](size_t count) {
+        if (fields.size() != count) {
+            throw invalid_argument("Expected " + to_string(count - 1) + " fields after \"" + command + "\".");
+        }
+    };
+    auto describe = [](const Event& event) {
+        return '\t' + event.getName() + '\t' + event.getDate() + '\t' + event.getStartTime() + '\t'
+             + event.getEndTime() + '\t' + event.getVenue() + '\t' + to_string(event.getSeats());
+    };
 
-                while (true) {
-                    try {
-                        cout << "Enter event start time (HH:MM): ";
-                        cin.ignore();
-                        getline(cin, startTime);
-                        cout << "Enter event end time (HH:MM): ";
-                        getline(cin, endTime);
-                        validateTime(startTime, endTime);
-                        startTime = roundTimeToNextInterval(startTime);
-                        endTime = roundTimeToNextInterval(endTime);
-                        break;
-                    } catch (const invalid_argument& e) {
-                        cerr << e.what() << endl;
-                    }
+    if (command == "add") {
+        expect(8);
+        int seats;
+        if (!FieldScanner::toInt(fields[7], seats)) {
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+        return describe(scheduleEvent(fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], seats));
+    }
+    if (command == "modify") {
+        return describe(changeEvent(fields[1], parseChanges(fields)));
+    }
+    if (command == "slots") {
+        if (fields.size() != 5 && fields.size() != 6) throw invalid_argument("Expected 4 or 5 fields after \"slots\".");
+        int seats, minutes, count = 5;
+        if (!FieldScanner::toInt(fields[1], seats) || !FieldScanner::toInt(fields[2], minutes)
+            || (fields.size() == 6 && (!FieldScanner::toInt(fields[5], count) || count <= 0 || count > 100))) {
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+        validateDate(fields[3]);
+        validateDate(fields[4]);
+        vector<EventStore::FreeSlot> options = findSlots(seats, minutes, DateTimeParser::parseDayNumber(fields[3]),
+                                                         DateTimeParser::parseDayNumber(fields[4]), count);
+        string result = '\t' + to_string(options.size());
+        for (const auto& option : options) {
+            result += '\n' + to_string(lineNo) + "\tROW\t" + DateTimeParser::formatDate(option.day) + '\t'
+                    + DateTimeParser::formatTime(option.startMinute) + '\t'
+                    + DateTimeParser::formatTime(option.startMinute + minutes) + '\t' + option.venue;
+        }
+        return result;
+    }
+    if (command == "series") {
+        expect(10);
+        int seats;
+        if (!FieldScanner::toInt(fields[7], seats)) {
+            throw invalid_argument("Invalid input. Please enter a number.");
+        }
+        EventSeries entry = scheduleSeries(prepareSeries(fields[1], fields[2], fields[3], fields[4], fields[5], fields[6],
+                                                         seats, fields[8], fields[9]));
+        return describe(entry.first) + '\t' + DateTimeParser::formatDate(entry.lastDay()) + '\t' + to_string(entry.count);
+    }
+    if (command == "delete") {
+        expect(2);
+        if (!store.remove(fields[1]) && !store.removeSeries(fields[1])) {
+            throw invalid_argument("Event \"" + fields[1] + "\" not found.");
+        }
+        return '\t' + fields[1];
+    }
+    if (command == "register") {
+        expect(6);
+        RegistrationIndex::Outcome outcome = enrolParticipant(Participant(fields[2], fields[3], fields[4], fields[5], fields[1]));
+        return '\t' + fields[1] + '\t' + to_string(registrations.count(fields[1]))
+             + (outcome.waitlisted ? "\twaitlisted\t" + to_string(outcome.position) : "\tregistered");
+    }
+    if (command == "unregister") {
+        expect(3);
+        RegistrationIndex::Cancellation result = withdrawParticipant(fields[1], fields[2]);
+        string reply = '\t' + fields[1] + '\t' + to_string(registrations.count(fields[1]));
+        for (const auto& promoted : result.promoted) reply += "\tpromoted\t" + promoted.getRollNumber();
+        return reply;
+    }
+    if (command == "query") {
+        Stats::Timer timer(Stats::Query);
+        if (fields.size() < 2) throw invalid_argument("Expected a query kind.");
+        const string& kind = fields[1];
+        if (kind == "series") {
+            expect(2);
+            string result = '\t' + to_string(store.allSeries().size());
+            for (const auto& entry : store.allSeries()) {
+                const Event& first = entry.first;
+                result += '\n' + to_string(lineNo) + "\tROW" + describe(first) + '\t' + first.getCategory() + '\t'
+                        + first.getOrganizer() + '\t' + to_string(registrations.count(first.getName())) + '\t'
+                        + (entry.intervalDays == 7 ? "weekly" : "biweekly") + '\t'
+                        + DateTimeParser::formatDate(entry.lastDay()) + '\t' + to_string(entry.count);
+            }
+            return result;
+        }
+        if (kind == "venues") {
+            expect(2);
+            string result = '\t' + to_string(venues.all().size());
+            for (const auto& venue : venues.all()) {
+                string attributes;
+                for (const auto& attribute : venue.attributes) attributes += (attributes.empty() ? "" : ";") + attribute;
+                result += '\n' + to_string(lineNo) + "\tROW\t" + venue.name + '\t' + to_string(venue.capacity) + '\t' + attributes;
+            }
+            return result;
+        }
+        EventTable matches;
+        if (kind == "event") {
+            expect(3);
+            size_t row = store.position(fields[2]);
+            if (row != EventNameIndex::npos) matches.append(store.table(), row);
+        } else if (kind == "all") {
+            matches = selectEvents(EventStore::Query(), parseListing(fields, 2));
+        } else if (kind == "category" || kind == "organizer") {
+            if (fields.size() < 3) throw invalid_argument("Expected 2 fields after \"" + command + "\".");
+            EventStore::Query query;
+            query.field = kind == "category" ? EventStore::Query::Category : EventStore::Query::Organizer;
+            query.value = fields[2];
+            matches = selectEvents(query, parseListing(fields, 3));
+        } else if (kind == "dates") {
+            if (fields.size() < 4) throw invalid_argument("Expected 3 fields after \"" + command + "\".");
+            EventStore::Query query;
+            query.firstDay = DateTimeParser::parseDayNumber(fields[2]);
+            query.lastDay = DateTimeParser::parseDayNumber(fields[3]);
+            // One of venue=, category= or organizer= may narrow the range.
+            vector<string> options;
+            for (size_t i = 4; i < fields.size(); ++i) {
+                size_t eq = fields[i].find('=');
+                string key = fields[i].substr(0, eq);
+                if (eq != string::npos && (key == "venue" || key == "category" || key == "organizer")) {
+                    if (query.field != EventStore::Query::Any) throw invalid_argument("Only one of venue, category or organizer may be given.");
+                    query.field = key == "venue" ? EventStore::Query::Venue
+                                : key == "category" ? EventStore::Query::Category : EventStore::Query::Organizer;
+                    query.value = fields[i].substr(eq + 1);
+                } else {
+                    options.push_back(fields[i]);
                 }
             }
+            matches = selectEvents(query, parseListing(options, 0));
+        } else {
+            throw invalid_argument("Unknown query \"" + kind + "\".");
         }
 
-        Event event(name, organizer, category, date, startTime, endTime, seats, venue);
-        event.save();
-        cout << "\nEvent successfully registered with the following details:\n";
-        event.display();
-    } catch (const invalid_argument& e) {
-        cerr << e.what() << endl;
+        string result = '\t' + to_string(matches.size());
+        for (size_t i = 0; i < matches.size(); ++i) {
+            string name(matches.name(i));
+            result += '\n' + to_string(lineNo) + "\tROW\t" + name + '\t' + DateTimeParser::formatDate(matches.day(i)) + '\t'
+                    + DateTimeParser::formatTime(matches.startMinute(i)) + '\t'
+                    + DateTimeParser::formatTime(matches.endMinute(i)) + '\t' + StringPool::lookup(matches.venue(i)) + '\t'
+                    + to_string(matches.seats(i)) + '\t' + Event::categoryName(matches.category(i)) + '\t'
+                    + StringPool::lookup(matches.organizer(i)) + '\t' + to_string(registrations.count(name));
+        }
+        return result;
     }
+    throw invalid_argument("Unknown command \"" + command + "\".");
 }
 
-void EventManagementSystem::displayCreatedEvents() {
-    vector<Event> events = Event::loadAll();
-    if (events.empty()) {
-        cout << "No events scheduled yet.\n";
-        return;
+// Benchmarks class definitions
+int Benchmarks::run(const string& which, int iterations) {
+    if (which == "validators") {
+        validators(iterations > 0 ? iterations : 20000);
+        return 0;
     }
+    if (which == "suite") {
+        suite(iterations > 0 ? size_t(iterations) : 100000);
+        return 0;
+    }
+    cerr << "Unknown benchmark \"" << which << "\"." << endl;
+    return 1;
+}
 
-    map<string, int> participantCount = Participant::countByEvent();
-    string currentOrganizer;
-
-    cout << "\nEnter Organizer Name: ";
-    cin.ignore();
-    getline(cin, currentOrganizer);
+// Compares the regex-based validation the scheduler used to do against the
+// single-pass parsers, on a mix of valid and invalid inputs.
+void Benchmarks::validators(int iterations) {
+    const vector<string> dates = {"2024-06-11", "2024-02-30", "1999-12-31", "2024/06/11", "2100-02-28"};
+    const vector<pair<string, string>> times = {{"09:15", "11:15"}, {"9:00", "10:30"}, {"07:00", "09:00"},
+                                                {"12:00", "11:00"}, {"10:7", "11:00"}};
 
-    bool foundEvent = false;
-    for (const auto& event : events) {
-        if (event.getOrganizer() == currentOrganizer) {
-            foundEvent = true;
-            event.display();
-            cout << "Registered Participants: " << participantCount[event.getName()] << endl;
+    auto legacyDate = [](const string& date) {
+        regex datePattern(R"(\d{4}-\d{2}-\d{2})");
+        if (!regex_match(date, datePattern)) return false;
+        int year = stoi(date.substr(0, 4));
+        int month = stoi(date.substr(5, 2));
+        int day = stoi(date.substr(8, 2));
+        return year >= 1900 && year <= 2100 && day >= 1 && day <= DateTimeParser::daysInMonth(year, month);
+    };
+    auto legacyTime = [](const string& startTime, const string& endTime) {
+        regex timePattern(R"((1[0-9]|2[0-3]|0?[0-9]):([0-5][0-9]))");
+        smatch matchStart, matchEnd;
+        if (!regex_match(startTime, matchStart, timePattern) || !regex_match(endTime, matchEnd, timePattern)) return false;
+        int startMinutes = stoi(matchStart[1].str()) * 60 + stoi(matchStart[2].str());
+        int endMinutes = stoi(matchEnd[1].str()) * 60 + stoi(matchEnd[2].str());
+        return startMinutes >= 8 * 60 && endMinutes > startMinutes && endMinutes <= 16 * 60;
+    };
+    auto currentDate = [](const string& date) {
+        try {
+            EventManagementSystem::validateDate(date);
+            return true;
+        } catch (const invalid_argument&) {
+            return false;
         }
-    }
+    };
+    auto currentTime = [](const string& startTime, const string& endTime) {
+        try {
+            EventManagementSystem::validateTime(startTime, endTime);
+            return true;
+        } catch (const invalid_argument&) {
+            return false;
+        }
+    };
 
-    if (!foundEvent) {
-        cout << "No events found for this organizer.\n";
-    }
-}
+    auto time = [iterations](const char* label, auto&& body) {
+        volatile int sink = 0;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) sink = sink + body(i);
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+        cout << left << setw(28) << label << fixed << setprecision(1) << setw(10) << ns << " ns/op" << endl;
+        return ns;
+    };
 
-void EventManagementSystem::participantMenu() {
-    try {
-        int choice;
-        cout << "\n1. Scheduled Events\n2. Register for an Event\n0. Exit\nEnter your choice: ";
-        cin >> choice;
-        cout << endl;
-        if (cin.fail()) {
-            cin.clear();
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');
-            throw invalid_argument("Invalid input. Please enter a number.");
-        }
-        if (choice == 0) return;
+    cout << "validators, " << iterations << " iterations" << endl;
+    double regexDate = time("date (std::regex)", [&](int i) { return legacyDate(dates[i % dates.size()]); });
+    double parsedDate = time("date (DateTimeParser)", [&](int i) { return currentDate(dates[i % dates.size()]); });
+    double regexTime = time("time (std::regex)", [&](int i) {
+        return legacyTime(times[i % times.size()].first, times[i % times.size()].second);
+    });
+    double parsedTime = time("time (DateTimeParser)", [&](int i) {
+        return currentTime(times[i % times.size()].first, times[i % times.size()].second);
+    });
+    cout << "speedup: date " << setprecision(1) << regexDate / parsedDate << "x, time " << regexTime / parsedTime << "x" << endl;
+}
 
-        switch (choice) {
-            case 1:
-                displayEventsForParticipants();
-                break;
-            case 2:
-                registerForEvent();
-                break;
-            default:
-                throw invalid_argument("Invalid choice. Returning to previous menu.");
-        }
-    } catch (const invalid_argument& e) {
-        cerr << e.what() << endl;
-    }
+// Server mode definitions
+mutex& EventManagementSystem::dayLock(int day) {
+    return dayLocks[(unsigned(day)) % DAY_LOCK_STRIPES];
 }
 
-void EventManagementSystem::displayEventsForParticipants() {
-    vector<Event> events = Event::loadAll();
-    if (events.empty()) {
-        cout << "No events found.\n";
-        return;
+// Runs one command for a client with the locking described on the class.
+// Returns the text that follows "N OK COMMAND", like runBatchCommand.
+string EventManagementSystem::serveCommand(const vector<string>& fields, size_t requestNo) {
+    const string& command = fields[0];
+    auto describe = [](const Event& event) {
+        return '\t' + event.getName() + '\t' + event.getDate() + '\t' + event.getStartTime() + '\t'
+             + event.getEndTime() + '\t' + event.getVenue() + '\t' + to_string(event.getSeats());
+    };
+
+    // Seats are reserved atomically inside RegistrationIndex, so
+    // registrations only need the event list to stay put.
+    if (command == "query" || command == "slots" || command == "register" || command == "unregister") {
+        shared_lock<shared_mutex> read(storeLock);
+        return runBatchCommand(fields, requestNo);
     }
 
-    map<string, int> participantCount = Participant::countByEvent();
-    displayEventsTable(events, participantCount);
-}
+    if (command == "add") {
+        if (fields.size() != 8) throw invalid_argument("Expected 7 fields after \"add\".");
+        int seats;
+        if (!FieldScanner::toInt(fields[7], seats)) throw invalid_argument("Invalid input. Please enter a number.");
+        Event prepared;
+        {
+            shared_lock<shared_mutex> read(storeLock);
+            prepared = prepareEvent(fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], seats);
+        }
 
-void EventManagementSystem::registerForEvent() {
-    string name, rollNumber, department, phoneNumber, eventName;
+        lock_guard<mutex> day(dayLock(prepared.getDay()));
+        string venue;
+        {
+            shared_lock<shared_mutex> read(storeLock);
+            venue = allocateVenue(prepared.getDay(), prepared.getStartMinute(), prepared.getEndMinute(), seats);
+        }
+        Event event(prepared.getName(), prepared.getOrganizer(), prepared.getCategory(), prepared.getDay(),
+                    prepared.getStartMinute(), prepared.getEndMinute(), seats, venue);
+        unique_lock<shared_mutex> write(storeLock);
+        if (!isEventNameUnique(event.getName())) {
+            throw invalid_argument("An event with this name already exists.");
+        }
+        store.add(event);
+        return describe(event);
+    }
 
-    try {
-        cout << "\nEnter the event name you want to register for: ";
-        cin.ignore();
-        getline(cin, eventName);
+    if (command == "modify") {
+        vector<pair<string, string>> changes = parseChanges(fields);
+        while (true) {
+            int currentDay, targetDay;
+            {
+                shared_lock<shared_mutex> read(storeLock);
+                optional<Event> current = store.find(fields[1]);
+                if (!current) throw invalid_argument("Event \"" + fields[1] + "\" not found.");
+                currentDay = targetDay = current->getDay();
+            }
+            for (const auto& change : changes) {
+                if (change.first == "date") {
+                    validateDate(change.second);
+                    targetDay = DateTimeParser::parseDayNumber(change.second);
+                }
+            }
 
-        vector<Event> events = Event::loadAll();
-        bool eventExists = false;
-        for (const auto& event : events) {
-            if (event.getName() == eventName) {
-                eventExists = true;
-                break;
+            // Lock both days' stripes in a fixed order so two moves cannot deadlock.
+            mutex* first = &dayLock(currentDay);
+            mutex* second = &dayLock(targetDay);
+            if (first > second) swap(first, second);
+            unique_lock<mutex> firstLock(*first);
+            unique_lock<mutex> secondLock;
+            if (second != first) secondLock = unique_lock<mutex>(*second);
+
+            Event modified;
+            {
+                shared_lock<shared_mutex> read(storeLock);
+                optional<Event> current = store.find(fields[1]);
+                if (!current) throw invalid_argument("Event \"" + fields[1] + "\" not found.");
+                if (current->getDay() != currentDay) continue;  // moved meanwhile; lock the right stripe
+                modified = planChange(*current, changes);
+            }
+            unique_lock<shared_mutex> write(storeLock);
+            if (modified.getName() != fields[1] && !isEventNameUnique(modified.getName())) {
+                throw invalid_argument("An event with this name already exists.");
+            }
+            if (!store.update(fields[1], modified)) {
+                throw invalid_argument("Event \"" + fields[1] + "\" not found.");
             }
+            registrations.renameEvent(fields[1], modified.getName());
+            registrations.promote(modified.getName(), modified.getSeats());
+            return describe(modified);
         }
+    }
 
-        if (!eventExists) {
-            throw invalid_argument("Error: The event \"" + eventName + "\" does not exist.");
+    if (command == "series") {
+        if (fields.size() != 10) throw invalid_argument("Expected 9 fields after \"series\".");
+        int seats;
+        if (!FieldScanner::toInt(fields[7], seats)) throw invalid_argument("Invalid input. Please enter a number.");
+        EventSeries prepared;
+        {
+            shared_lock<shared_mutex> read(storeLock);
+            prepared = prepareSeries(fields[1], fields[2], fields[3], fields[4], fields[5], fields[6], seats, fields[8],
+                                     fields[9]);
+        }
+        // Every occurrence's stripe is held, in stripe order as modify takes
+        // them, so an add that has checked a slot on one of these days
+        // commits before the series is placed, or checks after it.
+        array<bool, DAY_LOCK_STRIPES> needed{};
+        for (int i = 0; i < prepared.count; ++i) {
+            needed[&dayLock(prepared.first.getDay() + i * prepared.intervalDays) - dayLocks.data()] = true;
+        }
+        vector<unique_lock<mutex>> held;
+        for (size_t stripe = 0; stripe < DAY_LOCK_STRIPES; ++stripe) {
+            if (needed[stripe]) held.emplace_back(dayLocks[stripe]);
         }
+        unique_lock<shared_mutex> write(storeLock);
+        return runBatchCommand(fields, requestNo);
+    }
 
-        cout << "Enter your name: ";
-        getline(cin, name);
-        cout << "Enter your roll number: ";
-        getline(cin, rollNumber);
-        cout << "Enter your department: ";
-        getline(cin, department);
-        cout << "Enter your phone number: ";
-        getline(cin, phoneNumber);
+    unique_lock<shared_mutex> write(storeLock);
+    return runBatchCommand(fields, requestNo);
+}
 
-        Participant participant(name, rollNumber, department, phoneNumber, eventName);
-        participant.save();
-        cout << "Successfully registered for the event.\n";
-    } catch (const invalid_argument& e) {
-        cerr << e.what() << endl;
+#ifndef _WIN32
+namespace {
+atomic<bool> stopServer{false};
+
+void requestServerStop(int) {
+    stopServer = true;
+}
+
+bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
     }
+    return true;
+}
 }
 
-string EventManagementSystem::allocateVenue(const string& date, const string& startTime, const string& endTime, int seats) {
-    map<string, int> roomCapacities = {
-        {"Room 1", 35},
-       {"Room 2", 35},
-       {"ITB lab 1", 20},
-        {"ITB lab 2", 20},
-        {"Project lab", 40},
-        {"Programming lab", 40},
-        {"IT Conference room", 65},
-        {"CS Lab 3", 130},
-        {"Smart Conference Room", 210},
-        {"Auditorium", 500}
-    };
+// Reads newline-terminated commands and answers each in the batch format,
+// numbering requests per connection.
+void EventManagementSystem::serveClient(int fd) {
+    string pending;
+    char buffer[4096];
+    size_t requestNo = 0;
+    while (true) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+        pending.append(buffer, n);
 
-    vector<Event> events = Event::loadAll();
-    string allocatedRoom;
-    int minCapacityDifference = INT_MAX;
+        string replies;
+        size_t newline;
+        while ((newline = pending.find('\n')) != string::npos) {
+            string line = pending.substr(0, newline);
+            pending.erase(0, newline + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty() || line[0] == '#') continue;
 
-    for (const auto& room : roomCapacities) {
-        if (room.second >= seats && isRoomAvailable(events, date, startTime, endTime, room.first)) {
-            int capacityDifference = room.second - seats;
-            if (capacityDifference < minCapacityDifference) {
-                minCapacityDifference = capacityDifference;
-                allocatedRoom = room.first;
+            ++requestNo;
+            vector<string> fields = splitCommand(line);
+            try {
+                string result = serveCommand(fields, requestNo);
+                replies += to_string(requestNo) + "\tOK\t" + fields[0] + result + '\n';
+            } catch (const exception& e) {
+                replies += to_string(requestNo) + "\tERR\t" + fields[0] + '\t' + e.what() + '\n';
             }
         }
+        if (!replies.empty() && !sendAll(fd, replies)) break;
     }
+}
 
-    if (allocatedRoom.empty()) {
-        throw invalid_argument("No suitable room available for the given date and time.");
+// Accepts clients on a Unix domain socket until SIGINT or SIGTERM, one
+// thread per connection. On shutdown open connections are closed and
+// joined so the store and indexes are saved normally.
+int EventManagementSystem::serve(const string& socketPath) {
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (listener < 0 || socketPath.size() >= sizeof(address.sun_path)) {
+        cerr << "Unable to create socket " << socketPath << "." << endl;
+        return 1;
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socketPath.c_str());
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        cerr << "Unable to listen on " << socketPath << "." << endl;
+        close(listener);
+        return 1;
     }
 
-    return allocatedRoom;
-}
-
-void EventManagementSystem::deleteEvent() {
-    try {
-        string eventName;
-        cout << "\nEnter the name of the event you want to delete: ";
-        cin.ignore();
-        getline(cin, eventName);
+    struct sigaction action{};
+    action.sa_handler = requestServerStop;
+    sigaction(SIGINT, &action, nullptr);  // no SA_RESTART, so accept() returns EINTR
+    sigaction(SIGTERM, &action, nullptr);
+    cerr << "Serving on " << socketPath << endl;
 
-        vector<Event> events = Event::loadAll();
-        bool eventFound = false;
+    struct Client {
+        thread worker;
+        int fd;
+        atomic<bool> done{false};
+    };
+    list<Client> clients;
+    mutex clientsLock;  // guards Client::fd so shutdown never hits a recycled descriptor
 
-        for (auto it = events.begin(); it != events.end(); ++it) {
-            if (it->getName() == eventName) {
-                eventFound = true;
-                events.erase(it);
-                break;
+    while (!stopServer) {
+        int fd = accept(listener, nullptr, nullptr);
+        for (auto it = clients.begin(); it != clients.end();) {  // reap finished connections
+            if (it->done) {
+                it->worker.join();
+                it = clients.erase(it);
+            } else {
+                ++it;
             }
         }
+        if (fd < 0) continue;
 
-        ofstream file("events.txt");
-        if (file.is_open()) {
-            for (const auto& event : events) {
-                file << event.getName() << "," << event.getOrganizer() << "," << event.getCategory() << ","
-                     << event.getDate() << "," << event.getStartTime() << "," << event.getEndTime() << ","
-                     << event.getSeats() << "," << event.getVenue() << endl;
-            }
-            file.close();
-        } else {
-          //  cerr << "Unable to open file to save events." << endl;
+        clients.emplace_back();
+        Client& client = clients.back();
+        client.fd = fd;
+        client.worker = thread([this, &client, &clientsLock]() {
+            serveClient(client.fd);
+            lock_guard<mutex> guard(clientsLock);
+            close(client.fd);
+            client.fd = -1;
+            client.done = true;
+        });
+    }
+
+    close(listener);
+    unlink(socketPath.c_str());
+    {
+        lock_guard<mutex> guard(clientsLock);
+        for (auto& client : clients) {
+            if (client.fd >= 0) shutdown(client.fd, SHUT_RDWR);
         }
+    }
+    for (auto& client : clients) client.worker.join();
+    return 0;
+}
 
-        if (eventFound) {
-            cout << "Event \"" << eventName << "\" deleted successfully." << endl;
-        } else {
-            cout << "Event \"" << eventName << "\" not found." << endl;
+// Sends stdin to a running server and copies its replies to stdout.
+int EventManagementSystem::connect(const string& socketPath) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        cerr << "Unable to connect to " << socketPath << "." << endl;
+        return 1;
+    }
+
+    thread writer([fd]() {
+        string line;
+        while (getline(cin, line)) {
+            if (!sendAll(fd, line + '\n')) break;
         }
-    } catch (const exception& e) {
-        cerr << "Error deleting event: " << e.what() << endl;
+        shutdown(fd, SHUT_WR);
+    });
+    char buffer[4096];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        cout.write(buffer, n);
+        cout.flush();
     }
+    writer.join();
+    close(fd);
+    return 0;
+}
+#else
+int EventManagementSystem::serve(const string&) {
+    cerr << "Server mode needs Unix domain sockets." << endl;
+    return 1;
 }
 
-void EventManagementSystem::modifyEvent() {
-    try {
-        string eventName;
-        cout << "\nEnter the name of the event you want to modify: ";
-        cin.ignore();
-        getline(cin, eventName);
+int EventManagementSystem::connect(const string&) {
+    cerr << "Server mode needs Unix domain sockets." << endl;
+    return 1;
+}
+#endif
 
-        vector<Event> events = Event::loadAll();
-        bool eventFound = false;
-        Event modifiedEvent;
+// WorkloadGenerator class definitions
+void WorkloadGenerator::generate(const string& eventsPath, const string& participantsPath, const VenueCatalogue& venues,
+                                 const Options& options) {
+    static const char* topics[] = {"Algorithms", "Databases", "Networks", "Calculus", "Physics", "Ethics",
+                                   "Python", "Statistics", "Design", "Marketing", "Robotics", "Security"};
+    static const char* kinds[] = {"Intro to", "Advanced", "Workshop on", "Seminar:", "Exam:", "Talk on"};
+    static const char* categories[] = {"Workshop", "Seminar", "Lecture", "Exam", "Formal Event", "Miscellaneous"};
+    static const char* firstNames[] = {"Ayesha", "Musa", "Hadia", "Ali", "Sara", "Omar", "Zainab", "Bilal",
+                                       "Fatima", "Hamza", "Minahil", "Usman", "Noor", "Ahmed", "Hira", "Saad"};
+    static const char* lastNames[] = {"Khalid", "Iqbal", "Waqas", "Ahmed", "Akmal", "Zubair", "Raza", "Malik",
+                                      "Shah", "Butt", "Qureshi", "Siddiqui"};
+    static const char* departments[] = {"BSCS", "BSSE", "BSIT", "BBA", "BSDS"};
 
-        for (auto& event : events) {
-            if (event.getName() == eventName) {
-                eventFound = true;
-                modifiedEvent = event;
-                break;
-            }
+    mt19937_64 random(options.seed);
+    auto pick = [&random](size_t n) { return size_t(random() % n); };
+
+    vector<pair<string, int>> rooms;
+    for (const auto& venue : venues.all()) rooms.emplace_back(venue.name, venue.capacity);
+    const int slotsPerEvent = 6;  // the average event below is 1.5 hours
+    int days = options.days > 0 ? options.days
+             : max<int>(1, options.events * slotsPerEvent * 4 / (3 * rooms.size() * EventStore::SLOT_COUNT) + 1);
+
+    vector<string> organizers;
+    for (int i = 0; i < 200; ++i) {
+        organizers.push_back(string(i % 3 == 0 ? "Dr " : "") + firstNames[pick(16)] + " " + lastNames[pick(12)]);
+    }
+
+    // One mask per room per day, so generated bookings never collide.
+    vector<uint32_t> occupied(size_t(days) * rooms.size(), 0);
+    vector<string> names;
+    vector<int> seatCounts;
+    names.reserve(options.events);
+
+    string buffer;
+    ofstream events(eventsPath, ios::trunc);
+    size_t attempts = 0;
+    while (names.size() < options.events && attempts < options.events * 20) {
+        ++attempts;
+        int day = pick(days);
+        size_t room = pick(rooms.size());
+        int slots = 2 + pick(9);  // 30 minutes to 2.5 hours
+        int first = pick(EventStore::SLOT_COUNT - slots + 1);
+        uint32_t mask = ((1u << slots) - 1) << first;
+        uint32_t& busy = occupied[size_t(day) * rooms.size() + room];
+        if (busy & mask) continue;
+        busy |= mask;
+
+        int capacity = rooms[room].second;
+        int seats = max(1, capacity * int(40 + pick(61)) / 100);
+        string name = string(kinds[pick(6)]) + " " + topics[pick(12)] + " " + to_string(names.size() + 1);
+        int start = EventStore::DAY_START_MINUTE + first * EventStore::SLOT_MINUTES;
+        buffer += name + "," + organizers[pick(organizers.size())] + "," + categories[pick(6)] + ","
+                + DateTimeParser::formatDate(options.firstDay + day) + "," + DateTimeParser::formatTime(start) + ","
+                + DateTimeParser::formatTime(start + slots * EventStore::SLOT_MINUTES) + ","
+                + to_string(seats) + "," + rooms[room].first + "\n";
+        names.push_back(move(name));
+        seatCounts.push_back(seats);
+        if (buffer.size() > (1 << 20)) {
+            events << buffer;
+            buffer.clear();
         }
+    }
+    events << buffer;
+    events.close();
+    buffer.clear();
 
-        if (!eventFound) {
-            throw invalid_argument("Event \"" + eventName + "\" not found.");
+    size_t registrations = options.participants > 0 ? options.participants : names.size() * 3;
+    const size_t rollNumbers = 999999;
+    if (registrations > names.size() * rollNumbers) {
+        // Duplicates are skipped, so asking for more pairs than exist would never finish.
+        registrations = names.size() * rollNumbers;
+        cerr << "Only " << registrations << " distinct registrations are possible; generating that many." << endl;
+    }
+    ofstream participants(participantsPath, ios::trunc);
+    RegistrationKeys taken;  // one place per roll number and event, as enrol() enforces
+    for (size_t i = 0; i < registrations; ++i) {
+        string rollNumber = to_string(23000000 + pick(rollNumbers));
+        const string& eventName = names[pick(names.size())];
+        if (taken.contains(eventName, rollNumber)) {
+            --i;
+            continue;
         }
+        taken.insert(eventName, rollNumber);
+        buffer += string(firstNames[pick(16)]) + " " + lastNames[pick(12)] + "," + rollNumber + ","
+                + departments[pick(5)] + ",03" + to_string(100000000 + pick(899999999)) + "," + eventName + "\n";
+        if (buffer.size() > (1 << 20)) {
+            participants << buffer;
+            buffer.clear();
+        }
+    }
+    participants << buffer;
+    participants.close();
 
-        cout << "Enter new details (leave empty to keep current value):\n";
-        string input;
+    cerr << "Generated " << names.size() << " events over " << days << " days and " << registrations
+         << " registrations." << endl;
+}
 
-        cout << "Event Name [" << modifiedEvent.getName() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) modifiedEvent = Event(input, modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+void Benchmarks::report(const string& operation, size_t rows, vector<double>& nanos) {
+    sort(nanos.begin(), nanos.end());
+    auto percentile = [&nanos](double p) { return nanos[min(nanos.size() - 1, size_t(p * nanos.size()))] / 1000.0; };
+    double total = 0;
+    for (double n : nanos) total += n;
+    cout << left << setw(22) << operation << right << setw(9) << rows << setw(14) << fixed << setprecision(1)
+         << nanos.size() * 1e9 / total << setw(12) << percentile(0.50) << setw(12) << percentile(0.90)
+         << setw(12) << percentile(0.99) << setw(12) << nanos.back() / 1000.0 << endl;
+}
 
-        cout << "Organizer [" << modifiedEvent.getOrganizer() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) modifiedEvent = Event(modifiedEvent.getName(), input, modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+// Sizes grow tenfold from 1k. Whole-file operations are repeated a few
+// times and per-call operations a few thousand times, so each line's
+// percentiles come from individual timings.
+void Benchmarks::suite(size_t maxRows) {
+    string dir = "bench-data";
+#ifdef _WIN32
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
+    string eventsPath = dir + "/events.txt";
+    string participantsPath = dir + "/participants.txt";
 
-        cout << "Category [" << modifiedEvent.getCategory() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), input, modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+    cout << left << setw(22) << "operation" << right << setw(9) << "rows" << setw(14) << "ops/sec"
+         << setw(12) << "p50 us" << setw(12) << "p90 us" << setw(12) << "p99 us" << setw(12) << "max us" << endl;
 
-        cout << "Date [" << modifiedEvent.getDate() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) {
-            validateDate(input);
-            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), input, modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+    mt19937_64 random(7);
+    for (size_t rows = 1000; rows <= maxRows; rows *= 10) {
+        WorkloadGenerator::Options options;
+        options.events = rows;
+        WorkloadGenerator::generate(eventsPath, participantsPath, VenueCatalogue(), options);
+        std::remove((participantsPath + ".idx").c_str());
+
+        auto timeOnce = [](auto&& body) {
+            auto start = chrono::steady_clock::now();
+            body();
+            return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        };
+        int fileRuns = rows >= 1000000 ? 3 : 10;
+        int callRuns = 5000;
+
+        vector<double> nanos;
+        for (int run = 0; run < fileRuns; ++run) {
+            nanos.push_back(timeOnce([&]() { Event::loadAll(eventsPath); }));
         }
+        report("Event::loadAll", rows, nanos);
 
-        cout << "Start Time [" << modifiedEvent.getStartTime() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) {
-            validateTime(input, modifiedEvent.getEndTime());
-            input = roundTimeToNextInterval(input);
-            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), input, modifiedEvent.getEndTime(), modifiedEvent.getSeats(), modifiedEvent.getVenue());
+        nanos.clear();
+        for (int run = 0; run < fileRuns; ++run) {
+            nanos.push_back(timeOnce([&]() { Participant::countByEvent(participantsPath); }));
         }
+        report("countByEvent", rows, nanos);
 
-        cout << "End Time [" << modifiedEvent.getEndTime() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) {
-            validateTime(modifiedEvent.getStartTime(), input);
-            input = roundTimeToNextInterval(input);
-            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), input, modifiedEvent.getSeats(), modifiedEvent.getVenue());
+        EventManagementSystem system(eventsPath, participantsPath, dir + "/venues.txt");  // no file: built-in rooms, as generated
+        const EventTable& events = system.store.table();
+        int firstDay = events.empty() ? 0 : events.day(0);
+        int lastDay = firstDay;
+        for (size_t i = 0; i < events.size(); ++i) {
+            firstDay = min(firstDay, events.day(i));
+            lastDay = max(lastDay, events.day(i));
         }
 
-        cout << "Seats [" << modifiedEvent.getSeats() << "]: ";
-        getline(cin, input);
-        if (!input.empty()) {
-            modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), stoi(input), "");
-            try {
-                string allocatedVenue = allocateVenue(modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats());
-                cout << "Venue allocated: " << allocatedVenue << endl;
-                modifiedEvent = Event(modifiedEvent.getName(), modifiedEvent.getOrganizer(), modifiedEvent.getCategory(), modifiedEvent.getDate(), modifiedEvent.getStartTime(), modifiedEvent.getEndTime(), modifiedEvent.getSeats(), allocatedVenue);
-            } catch (const invalid_argument& e) {
-                cerr << e.what() << endl;
-                return;
-            }
+        nanos.clear();
+        for (int run = 0; run < callRuns; ++run) {
+            int day = firstDay + int(random() % (lastDay - firstDay + 1));
+            int start = EventStore::DAY_START_MINUTE + int(random() % 28) * EventStore::SLOT_MINUTES;
+            int seats = 10 + int(random() % 200);
+            nanos.push_back(timeOnce([&]() {
+                try {
+                    system.allocateVenue(day, start, start + 60, seats);
+                } catch (const invalid_argument&) {
+                }
+            }));
         }
+        report("allocateVenue", rows, nanos);
 
-        for (auto& event : events) {
-            if (event.getName() == eventName) {
-                event = modifiedEvent;
-                break;
-            }
+        nanos.clear();
+        for (int run = 0; run < callRuns; ++run) {
+            string name = run % 2 ? string(events.name(random() % events.size())) : "Missing event " + to_string(run);
+            nanos.push_back(timeOnce([&]() { system.isEventNameUnique(name); }));
         }
+        report("isEventNameUnique", rows, nanos);
 
-        ofstream file("events.txt");
-        if (file.is_open()) {
-            for (const auto& event : events) {
-                file << event.getName() << "," << event.getOrganizer() << "," << event.getCategory() << ","
-                     << event.getDate() << "," << event.getStartTime() << "," << event.getEndTime() << ","
-                     << event.getSeats() << "," << event.getVenue() << endl;
-            }
-            file.close();
-            cout << "Event modified successfully." << endl;
-        } else {
-         //   cerr << "Unable to open file to save events." << endl;
+        // The table goes to a discarding stream so the terminal is not measured.
+        ofstream discard;
+        streambuf* saved = cout.rdbuf(discard.rdbuf());
+        nanos.clear();
+        for (int run = 0; run < fileRuns; ++run) {
+            nanos.push_back(timeOnce([&]() { system.displayEventsTable(events); }));
         }
-    } catch (const exception& e) {
-        cerr << "Error modifying event: " << e.what() << endl;
+        cout.rdbuf(saved);
+        report("displayEventsTable", rows, nanos);
     }
+
+    std::remove(eventsPath.c_str());
+    std::remove((eventsPath + ".snapshot").c_str());
+    std::remove(participantsPath.c_str());
+    std::remove((participantsPath + ".idx").c_str());
+#ifdef _WIN32
+    _rmdir(dir.c_str());
+#else
+    rmdir(dir.c_str());
+#endif
 }
 
-bool EventManagementSystem::isRoomAvailable(const vector<Event>& events, const string& date, const string& startTime, const string& endTime, const string& room) {
-    for (const auto& event : events) {
-        if (event.getDate() == date && event.getVenue() == room) {
-            if (!(endTime <= event.getStartTime() || startTime >= event.getEndTime())) {
-                return false;
-            }
-        }
+// Auditor class definitions
+int Auditor::run(const string& eventsPath, const string& participantsPath, const VenueCatalogue& venues, ostream& out) {
+    try {
+        EventStore store(eventsPath);
+        store.load(true);
+        size_t problems = checkBookings(store, venues, out) + checkRegistrations(store, participantsPath, out);
+        out.flush();
+        cerr << "Audit found " << problems << (problems == 1 ? " problem." : " problems.") << endl;
+        return problems == 0 ? 0 : 2;
+    } catch (const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
     }
-    return true;
 }
 
-void EventManagementSystem::displayEventsTable(const vector<Event>& events, const map<string, int>& participantCount) {
-    cout << left << setw(20) << "Event Name" 
-         << setw(20) << "Organizer" 
-         << setw(12) << "Date" 
-         << setw(20) << "Time" 
-         << setw(20) << "Venue" 
-         << setw(8) << "Seats" 
-         << "Registered Participants" << endl;
-    cout << string(20 + 20 + 12 + 20 + 20 + 8 + 25, '-') << endl;
+size_t Auditor::checkBookings(const EventStore& store, const VenueCatalogue& venues, ostream& out) {
+    const EventTable& events = store.table();
+    const vector<EventSeries>& series = store.allSeries();
+    size_t problems = 0;
 
-    for (const auto& event : events) {
-        int registeredParticipants = 0;
-        auto it = participantCount.find(event.getName());
-        if (it != participantCount.end()) {
-            registeredParticipants = it->second;
-        }
-        cout << left << setw(20) << event.getName()
-             << setw(20) << event.getOrganizer()
-             << setw(12) << event.getDate()
-             << setw(20) << (event.getStartTime() + " - " + event.getEndTime())
-             << setw(20) << event.getVenue()
-             << setw(8) << event.getSeats()
-             << registeredParticipants << endl;
+    // Venues are ranked by name once, so the sort compares integers only.
+    vector<uint32_t> venueIds;
+    unordered_map<uint32_t, uint32_t> rank;
+    auto noteVenue = [&](uint32_t id) {
+        if (rank.emplace(id, 0).second) venueIds.push_back(id);
+    };
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (!events.isErased(i)) noteVenue(events.venue(i));
     }
-}
+    for (const auto& entry : series) noteVenue(entry.first.getVenueId());
+    sort(venueIds.begin(), venueIds.end(),
+         [](uint32_t a, uint32_t b) { return StringPool::lookup(a) < StringPool::lookup(b); });
+    for (size_t i = 0; i < venueIds.size(); ++i) rank[venueIds[i]] = i;
 
-void EventManagementSystem::printHeader(const string& title) {
-    int terminalWidth = 80; // Assume default terminal width
-    int titleWidth = title.size();
-    int leftPadding = (terminalWidth - titleWidth) / 2;
-    cout << setw(leftPadding) << "" << title << endl;
-}
+    auto checkSeats = [&](string_view name, int day, uint32_t venueId, int seats) {
+        const string& venue = StringPool::lookup(venueId);
+        const VenueCatalogue::Venue* room = venues.find(venue);
+        if (room == nullptr) {
+            out << "venue\t" << name << '\t' << DateTimeParser::formatDate(day) << '\t' << venue << '\n';
+            ++problems;
+        } else if (seats > room->capacity) {
+            out << "capacity\t" << name << '\t' << DateTimeParser::formatDate(day) << '\t' << venue << '\t' << seats
+                << '\t' << room->capacity << '\n';
+            ++problems;
+        }
+    };
 
-bool EventManagementSystem::isValidDateFormat(const string &date) {
-    regex datePattern(R"(\d{4}-\d{2}-\d{2})");
-    if (!regex_match(date, datePattern)) {
-        return false;
+    vector<Booking> bookings;
+    size_t occurrences = 0;
+    for (const auto& entry : series) occurrences += entry.count;
+    bookings.reserve(events.liveRows() + occurrences);
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events.isErased(i)) continue;
+        checkSeats(events.name(i), events.day(i), events.venue(i), events.seats(i));
+        bookings.push_back({rank[events.venue(i)], events.day(i), events.startMinute(i), events.endMinute(i),
+                            uint32_t(i), -1});
     }
+    for (size_t s = 0; s < series.size(); ++s) {
+        const Event& first = series[s].first;
+        checkSeats(first.getName(), first.getDay(), first.getVenueId(), first.getSeats());
+        uint32_t venueRank = rank[first.getVenueId()];
+        for (int k = 0; k < series[s].count; ++k) {
+            bookings.push_back({venueRank, first.getDay() + k * series[s].intervalDays, first.getStartMinute(),
+                                first.getEndMinute(), uint32_t(s), k});
+        }
+    }
+    sort(bookings.begin(), bookings.end(), [](const Booking& a, const Booking& b) {
+        return tie(a.venueRank, a.day, a.startMinute, a.endMinute, a.source, a.occurrence)
+             < tie(b.venueRank, b.day, b.startMinute, b.endMinute, b.source, b.occurrence);
+    });
 
-    int year = stoi(date.substr(0, 4));
-    int month = stoi(date.substr(5, 2));
-    int day = stoi(date.substr(8, 2));
-
-    if (month < 1 || month > 12) return false;
-    if (day < 1 || day > 31) return false;
+    auto name = [&](const Booking& booking) -> string_view {
+        return booking.occurrence < 0 ? events.name(booking.source) : string_view(series[booking.source].first.getName());
+    };
+    auto times = [](const Booking& booking) {
+        return DateTimeParser::formatTime(booking.startMinute) + "-" + DateTimeParser::formatTime(booking.endMinute);
+    };
 
-    if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30) return false;
-    if (month == 2) {
-        bool isLeapYear = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-        if ((isLeapYear && day > 29) || (!isLeapYear && day > 28)) return false;
+    // `running` is a min-heap, on end time, of the bookings in the current
+    // venue and day that have not ended by the current start. Every one of
+    // them overlaps the booking being visited.
+    vector<size_t> running;
+    auto endsLater = [&](size_t a, size_t b) { return bookings[a].endMinute > bookings[b].endMinute; };
+    for (size_t i = 0; i < bookings.size(); ++i) {
+        const Booking& current = bookings[i];
+        if (i > 0 && (bookings[i - 1].venueRank != current.venueRank || bookings[i - 1].day != current.day)) {
+            running.clear();
+        }
+        while (!running.empty() && bookings[running.front()].endMinute <= current.startMinute) {
+            pop_heap(running.begin(), running.end(), endsLater);
+            running.pop_back();
+        }
+        for (size_t earlier : running) {
+            const Booking& other = bookings[earlier];
+            out << "overlap\t" << StringPool::lookup(venueIds[current.venueRank]) << '\t'
+                << DateTimeParser::formatDate(current.day) << '\t' << name(other) << '\t' << times(other) << '\t'
+                << name(current) << '\t' << times(current) << '\n';
+            ++problems;
+        }
+        running.push_back(i);
+        push_heap(running.begin(), running.end(), endsLater);
     }
-
-    return true;
+    return problems;
 }
 
-bool EventManagementSystem::isEventNameUnique(const string& eventName) {
-    vector<Event> events = Event::loadAll();
-    for (const auto& event : events) {
-        if (event.getName() == eventName) {
-            return false;
+size_t Auditor::checkRegistrations(const EventStore& store, const string& participantsPath, ostream& out) {
+    struct Target {
+        int seats = -1;  // -1 if there is no such event or series
+        int registered = 0;
+    };
+    size_t problems = 0;
+    RegistrationKeys seen;
+    // One entry per event name seen in the files, so each line costs a
+    // single lookup here and the store is asked once per name.
+    unordered_map<string_view, Target> targets;
+    targets.reserve(store.table().size() + store.allSeries().size());
+
+    auto scan = [&](const string& path, MappedFile& file, bool seated) {
+        FieldScanner scanner(file.view());
+        string_view f[5];
+        while (scanner.nextLine()) {
+            if (scanner.line().empty()) continue;
+            if (!scanner.split(f, 5)) {
+                out << "malformed\t" << path << ':' << scanner.lineNumber() << '\n';
+                ++problems;
+                continue;
+            }
+            string_view eventName = f[4], rollNumber = f[1];
+            auto inserted = targets.try_emplace(eventName);
+            Target& target = inserted.first->second;
+            if (inserted.second) {
+                string key(eventName);
+                if (optional<Event> event = store.find(key)) {
+                    target.seats = event->getSeats();
+                } else if (const EventSeries* recurring = store.findSeries(key)) {
+                    target.seats = recurring->first.getSeats();
+                }
+            }
+            if (target.seats < 0) {
+                out << "orphan\t" << path << ':' << scanner.lineNumber() << '\t' << eventName << '\t' << rollNumber << '\n';
+                ++problems;
+                continue;
+            }
+            if (seen.contains(eventName, rollNumber)) {
+                out << "duplicate\t" << path << ':' << scanner.lineNumber() << '\t' << eventName << '\t' << rollNumber
+                    << '\n';
+                ++problems;
+            }
+            seen.insert(eventName, rollNumber);
+            if (seated) ++target.registered;
         }
+    };
+
+    // Both files stay mapped until the end, as `targets` holds views into them.
+    Stats::countParticipantsParse();
+    MappedFile participants(participantsPath);
+    scan(participantsPath, participants, true);
+    string waitlistPath = participantsPath + ".waitlist";
+    MappedFile waitlist(waitlistPath);
+    scan(waitlistPath, waitlist, false);
+
+    // Sorted so the report does not depend on hash order.
+    vector<pair<string_view, Target>> overbooked;
+    for (const auto& entry : targets) {
+        if (entry.second.registered > entry.second.seats && entry.second.seats >= 0) overbooked.push_back(entry);
     }
-    return true;
+    sort(overbooked.begin(), overbooked.end(),
+         [](const pair<string_view, Target>& a, const pair<string_view, Target>& b) { return a.first < b.first; });
+    for (const auto& entry : overbooked) {
+        out << "overbooked\t" << entry.first << '\t' << entry.second.registered << '\t' << entry.second.seats << '\n';
+        ++problems;
+    }
+    return problems;
 }